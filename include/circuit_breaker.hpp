@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace mcp {
+
+// ============================================================================
+// CircuitBreaker
+// ============================================================================
+//
+// Health of one upstream server, from a rolling window of call outcomes.
+// Failed calls (timeouts, lost connections, server errors) and calls slower
+// than `slowCall` count against it. Once at least `minCalls` calls in the
+// window fail at `failureRate` or more, the circuit opens and admit()
+// rejects at once instead of letting callers wait out their timeouts.
+// After `openFor`, the next admit() returns Probe: the caller sends a
+// cheap request (ping) and reports it with probeResult(). Success closes
+// the circuit; failure, or no answer within `probeTimeout`, reopens it.
+// Checking an open circuit is two relaxed atomic loads.
+
+class CircuitBreaker {
+public:
+    enum class State : uint8_t { Closed, Open, HalfOpen };
+    enum class Admit : uint8_t { Allow, Reject, Probe };
+
+    struct Options {
+        bool enabled = false;
+        std::chrono::milliseconds window{10000};
+        uint32_t minCalls = 20;
+        double failureRate = 0.5;
+        std::chrono::milliseconds slowCall{0};  // 0: latency is not judged
+        std::chrono::milliseconds openFor{5000};
+        std::chrono::milliseconds probeTimeout{5000};
+    };
+
+    struct Metrics {
+        State state = State::Closed;
+        uint32_t calls = 0;     // in the current window
+        uint32_t failures = 0;  // in the current window, slow calls included
+        uint64_t opened = 0;    // times the circuit has opened
+        uint64_t rejected = 0;  // calls failed fast
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t Buckets = 10;
+
+    struct Bucket {
+        int64_t slot = -1;
+        uint32_t calls = 0;
+        uint32_t failures = 0;
+    };
+
+    Options options;
+    Clock::duration bucketWidth;
+
+    // `until` is written before `state` changes; storing `state` with
+    // release and loading it with acquire makes a reader of the new state
+    // see the matching `until`
+    std::atomic<State> state{State::Closed};
+    std::atomic<Clock::rep> until{0};  // Open: earliest probe; HalfOpen: probe deadline
+    std::atomic<uint64_t> opened{0};
+    std::atomic<uint64_t> rejected{0};
+
+    std::mutex mutex;
+    std::array<Bucket, Buckets> buckets{};
+
+    static Clock::rep ticks(Clock::time_point t) { return t.time_since_epoch().count(); }
+
+    int64_t slotOf(Clock::time_point t) const { return t.time_since_epoch() / bucketWidth; }
+
+    void open(Clock::time_point now) {
+        until.store(ticks(now + options.openFor), std::memory_order_relaxed);
+        state.store(State::Open, std::memory_order_release);
+        ++opened;
+    }
+
+    void clearWindow() {
+        buckets.fill(Bucket{});
+    }
+
+public:
+    CircuitBreaker() : CircuitBreaker(Options{}) {}
+
+    explicit CircuitBreaker(const Options& opts)
+        : options(opts),
+          bucketWidth(std::max<Clock::duration>(std::chrono::duration_cast<Clock::duration>(opts.window) / Buckets,
+                                                std::chrono::milliseconds(1))) {}
+
+    bool enabled() const { return options.enabled; }
+
+    State current() const { return state.load(); }
+
+    Admit admit() {
+        if (!options.enabled) {
+            return Admit::Allow;
+        }
+        State s = state.load(std::memory_order_acquire);
+        if (s == State::Closed) {
+            return Admit::Allow;
+        }
+        const auto now = Clock::now();
+        if (ticks(now) < until.load(std::memory_order_relaxed)) {
+            ++rejected;
+            return Admit::Reject;
+        }
+        if (s == State::HalfOpen) {
+            // Probe unanswered: count it as failed
+            if (state.compare_exchange_strong(s, State::Open)) {
+                open(now);
+            }
+            ++rejected;
+            return Admit::Reject;
+        }
+        // One caller wins the right to probe. The deadline goes first so no
+        // one sees HalfOpen with the expired open period.
+        until.store(ticks(now + options.probeTimeout), std::memory_order_relaxed);
+        if (!state.compare_exchange_strong(s, State::HalfOpen)) {
+            ++rejected;
+            return Admit::Reject;
+        }
+        ++rejected;
+        return Admit::Probe;
+    }
+
+    void record(bool ok, Clock::duration latency) {
+        if (!options.enabled) {
+            return;
+        }
+        if (options.slowCall.count() > 0 && latency >= options.slowCall) {
+            ok = false;
+        }
+        const auto now = Clock::now();
+        const int64_t slot = slotOf(now);
+        std::lock_guard<std::mutex> lock(mutex);
+        Bucket& b = buckets[static_cast<size_t>(slot) % Buckets];
+        if (b.slot != slot) {
+            b = Bucket{slot, 0, 0};
+        }
+        ++b.calls;
+        if (!ok) {
+            ++b.failures;
+        } else {
+            return;
+        }
+        if (state.load(std::memory_order_acquire) != State::Closed) {
+            return;
+        }
+        uint32_t calls = 0, failures = 0;
+        for (const auto& bucket : buckets) {
+            if (bucket.slot > slot - static_cast<int64_t>(Buckets)) {
+                calls += bucket.calls;
+                failures += bucket.failures;
+            }
+        }
+        if (calls >= options.minCalls && failures >= options.failureRate * calls) {
+            open(now);
+        }
+    }
+
+    void probeResult(bool ok) {
+        State s = State::HalfOpen;
+        if (ok) {
+            if (state.compare_exchange_strong(s, State::Closed)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                clearWindow();
+            }
+        } else if (state.compare_exchange_strong(s, State::Open)) {
+            open(Clock::now());
+        }
+    }
+
+    // The transport gave up on the server (ConnectionStatus::ERROR)
+    void trip() {
+        if (options.enabled && state.exchange(State::Open) != State::Open) {
+            open(Clock::now());
+        }
+    }
+
+    // A fresh connection: let the next call probe without waiting out openFor
+    void allowProbe() {
+        if (state.load() == State::Open) {
+            until.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Metrics metrics() {
+        Metrics m;
+        m.state = state.load();
+        m.opened = opened.load();
+        m.rejected = rejected.load();
+        const int64_t slot = slotOf(Clock::now());
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& bucket : buckets) {
+            if (bucket.slot > slot - static_cast<int64_t>(Buckets)) {
+                m.calls += bucket.calls;
+                m.failures += bucket.failures;
+            }
+        }
+        return m;
+    }
+};
+
+} // namespace mcp
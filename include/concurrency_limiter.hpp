@@ -0,0 +1,451 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mcp {
+
+// ============================================================================
+// ConcurrencyLimiter
+// ============================================================================
+//
+// Adaptive cap on the requests in flight to one server. Each round trip is
+// compared with the server's no-load RTT (the minimum over the last
+// `minRttWindow` samples); a larger RTT means requests are queueing
+// upstream and the limit is above the server's capacity.
+//
+//   Gradient  limit = limit * clamp(tolerance * minRtt / rtt, 0.5, 1) + sqrt(limit),
+//             smoothed, once per round trip with rtt the round's mean. Grows by ~sqrt(limit) while RTT stays within
+//             `tolerance` of the minimum, shrinks in proportion beyond.
+//   Aimd      +1 per round trip while the limit is in use; * backoffRatio,
+//             at most once per round trip, on overload or when RTT
+//             exceeds tolerance * minRtt.
+//
+// Timeouts and ServerBusy answers count as overload under both. The limit
+// only grows while at least half of it is in use, so an idle client does
+// not inflate it. When capacity changes the RTT moves with it, and the
+// limit follows.
+//
+//   Fixed     the limit stays at initialLimit; only the queue below is used.
+//
+// Requests over the limit wait in a bounded queue, one FIFO lane per
+// Priority. Freed slots go to the lanes in proportion to their weights
+// (stride scheduling), so a burst of Low requests cannot hold back High
+// ones, and Low still gets its share. A request is shed at once when its
+// deadline falls before its estimated turn; when the queue is full, the
+// lowest-priority waiter with the earliest deadline is shed.
+//
+// acquire() blocks the calling thread in the queue. acquireAsync() queues
+// a callback instead, for callers that must not hold a thread while they
+// wait (see AsyncClient).
+
+enum class Priority : uint8_t { Low, Normal, High };
+
+class ConcurrencyLimiter {
+public:
+    enum class Algorithm : uint8_t { Gradient, Aimd, Fixed };
+    enum class Outcome : uint8_t { Success, Overload, Ignore };
+    static constexpr size_t Lanes = 3;
+
+    struct Options {
+        bool enabled = false;
+        Algorithm algorithm = Algorithm::Gradient;
+        int initialLimit = 20;
+        int minLimit = 1;
+        int maxLimit = 200;
+        size_t maxQueued = 100;
+        double backoffRatio = 0.9;
+        double smoothing = 0.2;
+        double tolerance = 1.5;
+        // Samples over which the no-load RTT is the minimum
+        uint32_t minRttWindow = 1000;
+        // Share of freed slots per Priority, Low to High, while lanes wait
+        std::array<uint32_t, Lanes> weights{1, 4, 16};
+    };
+
+    struct Metrics {
+        int limit = 0;
+        int inflight = 0;
+        size_t queued = 0;
+        std::array<size_t, Lanes> queuedByPriority{};
+        uint64_t shed = 0;
+        std::chrono::microseconds minRtt{0};
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Waiter {
+        Clock::time_point deadline;
+        size_t lane = 0;
+        std::condition_variable cv;
+        bool granted = false;
+        bool shed = false;
+        // acquireAsync(): owned by the queue, told through `done`
+        std::function<void(bool)> done;
+        uint64_t ticket = 0;
+    };
+
+    Options options;
+    std::mutex mutex;
+    double limit;
+    int inflight = 0;
+    double minRtt = 0;  // microseconds; 0 until the first sample
+    double windowMin = 0;
+    uint32_t windowSamples = 0;
+    double roundSum = 0;
+    uint32_t roundSamples = 0;
+    Clock::time_point roundEnd{};
+    Clock::time_point backedOff{};
+    uint64_t shedCount = 0;
+    std::array<std::deque<Waiter*>, Lanes> lanes;
+    std::array<double, Lanes> pass{};  // stride scheduling: next lane is the lowest pass
+    double virtualTime = 0;
+    size_t queued = 0;
+    uint64_t nextTicket = 1;
+    std::vector<Waiter*> answered;  // async waiters granted or shed, told once unlocked
+
+    int currentLimit() const { return static_cast<int>(limit); }
+
+    void wake(Waiter* w) {
+        if (w->done) {
+            answered.push_back(w);
+        } else {
+            w->cv.notify_one();
+        }
+    }
+
+    void shed(Waiter* w) {
+        w->shed = true;
+        ++shedCount;
+        wake(w);
+    }
+
+    // Runs the callbacks of answered async waiters without the lock
+    void tell(std::unique_lock<std::mutex>& lock) {
+        if (answered.empty()) {
+            return;
+        }
+        auto ready = std::move(answered);
+        answered.clear();
+        lock.unlock();
+        for (Waiter* w : ready) {
+            std::unique_ptr<Waiter> owned(w);
+            owned->done(owned->granted);
+        }
+        lock.lock();
+    }
+
+    void enqueue(Waiter* w) {
+        auto& lane = lanes[w->lane];
+        // A lane that was idle starts level with the others instead of
+        // cashing in the turns it did not need
+        if (lane.empty()) {
+            pass[w->lane] = std::max(pass[w->lane], virtualTime);
+        }
+        lane.push_back(w);
+        ++queued;
+    }
+
+    void remove(Waiter* w) {
+        auto& lane = lanes[w->lane];
+        lane.erase(std::find(lane.begin(), lane.end(), w));
+        --queued;
+    }
+
+    Waiter* next() {
+        size_t best = Lanes;
+        for (size_t i = 0; i < Lanes; ++i) {
+            if (!lanes[i].empty() && (best == Lanes || pass[i] < pass[best])) {
+                best = i;
+            }
+        }
+        if (best == Lanes) {
+            return nullptr;
+        }
+        virtualTime = pass[best];
+        pass[best] += 1.0 / options.weights[best];
+        Waiter* w = lanes[best].front();
+        lanes[best].pop_front();
+        --queued;
+        return w;
+    }
+
+    // Hands free slots to waiters by lane weight, oldest first within a
+    // lane; skips expired ones
+    void grant() {
+        const auto now = Clock::now();
+        while (queued > 0 && inflight < currentLimit()) {
+            Waiter* w = next();
+            if (w->deadline <= now) {
+                shed(w);
+                continue;
+            }
+            ++inflight;
+            w->granted = true;
+            wake(w);
+        }
+    }
+
+    // Waiters served before a new one in `lane`: its own lane, plus the
+    // others' weighted share of the turns until then
+    Clock::duration estimatedWait(size_t lane) const {
+        const double ahead = static_cast<double>(lanes[lane].size() + 1);
+        double turns = ahead;
+        for (size_t i = 0; i < Lanes; ++i) {
+            if (i != lane) {
+                turns += std::min(static_cast<double>(lanes[i].size()),
+                                  ahead * options.weights[i] / options.weights[lane]);
+            }
+        }
+        const double perSlot = minRtt / std::max(limit, 1.0);
+        return std::chrono::microseconds(static_cast<int64_t>(perSlot * turns));
+    }
+
+    // The waiter to shed for a newcomer when the queue is full: the
+    // earliest deadline in the lowest lane, if that ranks below `w`
+    Waiter* victim(const Waiter& w) const {
+        for (size_t i = 0; i <= w.lane; ++i) {
+            if (lanes[i].empty()) {
+                continue;
+            }
+            Waiter* earliest = *std::min_element(lanes[i].begin(), lanes[i].end(),
+                                                 [](const Waiter* a, const Waiter* b) { return a->deadline < b->deadline; });
+            return i < w.lane || earliest->deadline < w.deadline ? earliest : nullptr;
+        }
+        return nullptr;
+    }
+
+    void sampleRtt(double rttUs) {
+        rttUs = std::max(rttUs, 1.0);
+        windowMin = windowSamples == 0 ? rttUs : std::min(windowMin, rttUs);
+        if (minRtt == 0 || rttUs < minRtt) {
+            minRtt = rttUs;
+        }
+        // Each window lets a server that got slower for good move the
+        // baseline up, a tenth of the way, so one window spent queueing
+        // does not turn the queueing delay into the baseline
+        if (++windowSamples >= options.minRttWindow) {
+            minRtt += (windowMin - minRtt) * 0.1;
+            windowSamples = 0;
+        }
+    }
+
+    void adjust(double rttUs, Outcome outcome, int inUse) {
+        if (options.algorithm == Algorithm::Fixed) {
+            return;
+        }
+        const auto now = Clock::now();
+        if (outcome == Outcome::Success) {
+            sampleRtt(rttUs);
+        }
+        const bool queueing = rttUs > options.tolerance * minRtt;
+        double next = limit;
+        if (outcome == Outcome::Overload || (options.algorithm == Algorithm::Aimd && queueing)) {
+            // Requests sent before the last backoff report the old limit
+            if (now < backedOff) {
+                return;
+            }
+            backedOff = now + std::chrono::microseconds(static_cast<int64_t>(rttUs));
+            next = limit * options.backoffRatio;
+        } else if (options.algorithm == Algorithm::Aimd) {
+            next = limit + 1 / limit;
+        } else {
+            // A change takes a round trip to show in the RTT
+            roundSum += rttUs;
+            ++roundSamples;
+            if (now < roundEnd) {
+                return;
+            }
+            const double rtt = roundSum / roundSamples;
+            roundSum = 0;
+            roundSamples = 0;
+            roundEnd = now + std::chrono::microseconds(static_cast<int64_t>(rtt));
+            const double gradient = std::clamp(options.tolerance * minRtt / std::max(rtt, 1.0), 0.5, 1.0);
+            next = limit * gradient + std::sqrt(limit);
+            next = limit * (1 - options.smoothing) + next * options.smoothing;
+        }
+        // Application-limited: the sample says nothing about headroom
+        if (next > limit && inUse * 2 < currentLimit()) {
+            return;
+        }
+        limit = std::clamp(next, static_cast<double>(options.minLimit), static_cast<double>(options.maxLimit));
+    }
+
+public:
+    ConcurrencyLimiter() : ConcurrencyLimiter(Options{}) {}
+
+    explicit ConcurrencyLimiter(const Options& opts) : options(opts) {
+        options.minLimit = std::max(options.minLimit, 1);
+        options.maxLimit = std::max(options.maxLimit, options.minLimit);
+        options.minRttWindow = std::max<uint32_t>(options.minRttWindow, 1);
+        options.tolerance = std::max(options.tolerance, 1.0);
+        for (auto& w : options.weights) {
+            w = std::max<uint32_t>(w, 1);
+        }
+        limit = std::clamp(options.initialLimit, options.minLimit, options.maxLimit);
+    }
+
+    // Async waiters still queued are dropped without being told
+    ~ConcurrencyLimiter() {
+        for (auto& lane : lanes) {
+            for (Waiter* w : lane) {
+                if (w->done) {
+                    delete w;
+                }
+            }
+        }
+    }
+
+    ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+    ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+    bool enabled() const { return options.enabled; }
+
+    // Takes a slot, waiting for one until `deadline`. Returns false if the
+    // request was shed; the caller must not send it.
+    bool acquire(Clock::time_point deadline, Priority priority = Priority::Normal) {
+        if (!options.enabled) {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queued == 0 && inflight < currentLimit()) {
+            ++inflight;
+            return true;
+        }
+        Waiter self;
+        self.deadline = deadline;
+        self.lane = std::min(static_cast<size_t>(priority), Lanes - 1);
+        const auto now = Clock::now();
+        if (options.maxQueued == 0 || now + estimatedWait(self.lane) > deadline) {
+            ++shedCount;
+            return false;
+        }
+        if (queued >= options.maxQueued) {
+            Waiter* w = victim(self);
+            if (!w) {
+                ++shedCount;
+                return false;
+            }
+            remove(w);
+            shed(w);
+        }
+        enqueue(&self);
+        tell(lock);
+        self.cv.wait_until(lock, deadline, [&] { return self.granted || self.shed; });
+        if (self.granted) {
+            return true;
+        }
+        if (!self.shed) {
+            remove(&self);
+            ++shedCount;
+        }
+        return false;
+    }
+
+    enum class Admission : uint8_t { Granted, Shed, Queued };
+
+    // acquire() without blocking. Granted and Shed are answered at once, as
+    // acquire() would; `done` is not called. Queued means `done` runs later,
+    // outside the lock, on the thread that freed a slot (done(true), the
+    // slot taken) or shed the request (done(false)). `*ticket` names it for
+    // withdraw(). An expired request is shed when slots free up; the caller
+    // withdraws it at its deadline if none do.
+    Admission acquireAsync(Clock::time_point deadline, Priority priority, std::function<void(bool)> done,
+                           uint64_t* ticket) {
+        if (!options.enabled) {
+            return Admission::Granted;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queued == 0 && inflight < currentLimit()) {
+            ++inflight;
+            return Admission::Granted;
+        }
+        auto self = std::make_unique<Waiter>();
+        self->deadline = deadline;
+        self->lane = std::min(static_cast<size_t>(priority), Lanes - 1);
+        if (options.maxQueued == 0 || Clock::now() + estimatedWait(self->lane) > deadline) {
+            ++shedCount;
+            return Admission::Shed;
+        }
+        if (queued >= options.maxQueued) {
+            Waiter* w = victim(*self);
+            if (!w) {
+                ++shedCount;
+                return Admission::Shed;
+            }
+            remove(w);
+            shed(w);
+        }
+        self->done = std::move(done);
+        self->ticket = nextTicket++;
+        *ticket = self->ticket;
+        enqueue(self.release());
+        tell(lock);
+        return Admission::Queued;
+    }
+
+    // Takes a request queued by acquireAsync() out of the queue; `expired`
+    // counts it as shed. False if it already left: its `done` has run or
+    // is about to.
+    bool withdraw(uint64_t ticket, bool expired) {
+        if (ticket == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& lane : lanes) {
+            auto it = std::find_if(lane.begin(), lane.end(), [&](const Waiter* w) { return w->ticket == ticket; });
+            if (it != lane.end()) {
+                std::unique_ptr<Waiter> owned(*it);
+                lane.erase(it);
+                --queued;
+                if (expired) {
+                    ++shedCount;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns a slot. `rtt` is the request's round trip; Ignore releases
+    // without a sample (cancelled, connection lost).
+    void release(Clock::duration rtt, Outcome outcome) {
+        if (!options.enabled) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        const int inUse = inflight;
+        --inflight;
+        if (outcome != Outcome::Ignore) {
+            adjust(static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(rtt).count()), outcome,
+                   inUse);
+        }
+        grant();
+        tell(lock);
+    }
+
+    Metrics metrics() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Metrics m;
+        m.limit = currentLimit();
+        m.inflight = inflight;
+        m.queued = queued;
+        for (size_t i = 0; i < Lanes; ++i) {
+            m.queuedByPriority[i] = lanes[i].size();
+        }
+        m.shed = shedCount;
+        m.minRtt = std::chrono::microseconds(static_cast<int64_t>(minRtt));
+        return m;
+    }
+};
+
+} // namespace mcp
@@ -0,0 +1,745 @@
+#pragma once
+// C++20 only: compiles to nothing in a C++17 build
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include "mcp.hpp"
+#include "timer_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mcp {
+
+// ============================================================================
+// Task
+// ============================================================================
+//
+// Lazy coroutine returning T. It starts when first awaited; on completion
+// it resumes its awaiter directly (symmetric transfer), on whatever thread
+// it finished, so a chain of tasks costs no extra hops and no stack depth.
+// launch() runs a task from ordinary code and hands back a future.
+//
+//     Task<std::string> firstTool(AsyncClient& client) {
+//         auto tools = co_await client.listTools();
+//         co_return tools.empty() ? "" : tools.front().name.str();
+//     }
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    struct Final {
+        bool await_ready() noexcept { return false; }
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> done) noexcept {
+            auto next = done.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    Final final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <class T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T v) { value.emplace(std::move(v)); }
+
+    T result() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+
+    void result() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+} // namespace detail
+
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() { return handle.promise().result(); }
+};
+
+namespace detail {
+
+template <class T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Owns itself: starts at once and frees its frame when done
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template <class T>
+Detached runTask(Task<T> task, std::promise<T> promise) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            promise.set_value();
+        } else {
+            promise.set_value(co_await std::move(task));
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+// Starts `task` on the calling thread; it runs there until its first
+// suspension and continues wherever its calls resume it
+template <class T>
+std::future<T> launch(Task<T> task) {
+    std::promise<T> promise;
+    auto future = promise.get_future();
+    detail::runTask(std::move(task), std::move(promise));
+    return future;
+}
+
+// ============================================================================
+// CancellationToken
+// ============================================================================
+//
+// Cancels a group of awaited calls, e.g. everything a session started.
+// Copies share one state. cancel() withdraws every call still awaiting under
+// the token, with notifications/cancelled, and their co_await throws
+// RpcError(RequestCancelled); calls awaited after that throw without being
+// sent. A default-constructed token is never cancelled.
+
+class CancellationToken {
+    struct State {
+        std::mutex mutex;
+        bool cancelled = false;
+        std::string reason;
+        uint64_t nextId = 1;
+        std::unordered_map<uint64_t, std::function<void(const std::string&)>> callbacks;
+    };
+    std::shared_ptr<State> state;
+
+public:
+    CancellationToken() = default;
+
+    static CancellationToken create() {
+        CancellationToken token;
+        token.state = std::make_shared<State>();
+        return token;
+    }
+
+    void cancel(const std::string& reason = {}) {
+        if (!state) return;
+        std::unordered_map<uint64_t, std::function<void(const std::string&)>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->cancelled) return;
+            state->cancelled = true;
+            state->reason = reason;
+            callbacks.swap(state->callbacks);
+        }
+        for (auto& [id, callback] : callbacks) {
+            callback(reason);
+        }
+    }
+
+    bool cancelled() const {
+        if (!state) return false;
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->cancelled;
+    }
+
+    // Runs `callback` on cancel(), or at once if already cancelled. Returns
+    // an id for unsubscribe(); 0 when the callback will never run.
+    uint64_t subscribe(std::function<void(const std::string&)> callback) const {
+        if (!state) return 0;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (state->cancelled) {
+            const auto reason = state->reason;
+            lock.unlock();
+            callback(reason);
+            return 0;
+        }
+        const uint64_t id = state->nextId++;
+        state->callbacks.emplace(id, std::move(callback));
+        return id;
+    }
+
+    void unsubscribe(uint64_t id) const {
+        if (!state || id == 0) return;
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->callbacks.erase(id);
+    }
+};
+
+// ============================================================================
+// AsyncClient
+// ============================================================================
+//
+// Awaitable calls on an mcp client for C++20 coroutines:
+//
+//     Task<> session(AsyncClient& client, CancellationToken cancel) {
+//         auto tools = co_await client.listTools({}, cancel);
+//         const type::Symbol search("search");
+//         nlohmann::json arguments = {{"q", "mcp"}};
+//         auto result = co_await client.callTool(search, std::move(arguments), {}, cancel);
+//         ...
+//     }
+//
+// (GCC 12 rejects string literals inside a co_await expression with "array
+// used as initializer"; build the arguments before the co_await.)
+//
+// A call is checked, limited and validated as callAsync() would, but no
+// wait before sending holds a thread: a rate limit wait is a timer on
+// TimerQueue::shared(), and a turn in the concurrency limiter's queue a
+// callback (ConcurrencyLimiter::acquireAsync). A call that can go at once
+// is sent from the awaiting thread, one that waited from `executor`. The
+// coroutine then suspends, holding no thread, until the call settles, and
+// is resumed on `executor` (or inline on the settling thread if the
+// executor's queue is full). Nothing waits on a future, so thousands of
+// sessions can share a handful of threads.
+//
+// The call's deadline (see CallOptions::deadline) is a timer on
+// TimerQueue::shared(): when it fires first, the request is withdrawn with
+// notifications/cancelled, counted as overload like a timeout in call(),
+// and the co_await throws RpcError(RequestTimeout). Cancelling the token
+// withdraws it with RpcError(RequestCancelled) the same way. Either one
+// ends a wait before sending, with its rate limit tokens refunded.
+//
+// Unlike call(), a failed call is not retried. The mcp client must outlive
+// its AsyncClient and every call in flight.
+
+class AsyncClient {
+    mcp& client;
+    std::shared_ptr<Executor> executor;
+
+    using Prepare = std::function<mcp::Outgoing(const CallOptions&)>;
+
+    struct CallState {
+        mcp* client = nullptr;
+        std::future<nlohmann::json> future;
+        std::coroutine_handle<> awaiting;
+        std::shared_ptr<Executor> executor;
+        // Suspended and done (settled, or failed before it was sent):
+        // whichever comes second resumes
+        std::atomic<int> arrivals{0};
+        std::optional<TimerQueue::Timer> timer;
+        CancellationToken cancel;
+        uint64_t subscription = 0;
+
+        // How the deadline or the token ends the call: withdraw()'s arguments
+        struct Stop {
+            std::string reason;
+            RpcError error;
+            ConcurrencyLimiter::Outcome outcome;
+            bool expired;
+        };
+
+        // Where the request is. A stop while it waits for its rate limit
+        // tokens (Waiting) or in the limiter's queue (Queued) ends the wait.
+        // One that comes while the wait is ending (Queuing, the timer
+        // firing, a slot being granted) or while it is sent is left in
+        // `stopped` for the thread moving it on.
+        enum class Stage : uint8_t { Waiting, Queuing, Queued, Sending, Sent, Failed };
+        mcp::Outgoing request;
+        CallOptions options;
+        Deadline deadline{};
+        Stage stage = Stage::Sending;
+        std::optional<TimerQueue::Timer> due;
+        uint64_t ticket = 0;
+        int requestId = 0;
+        std::optional<Stop> stopped;
+        std::exception_ptr failed;
+
+        std::mutex mutex;
+        bool settled = false;
+        int busy = 0;           // threads inside the client for this call
+        bool deferred = false;  // settled meanwhile: arrive once they return
+
+        // Runs `withdraw` on the client unless the call has settled. A
+        // settlement meanwhile holds the coroutine back until it returns, so
+        // the client, which outlives every call in flight, is alive for it.
+        // Never touches a client whose call already resumed.
+        template <class Withdraw>
+        static void guard(const std::weak_ptr<CallState>& weak, Withdraw withdraw) {
+            const auto s = weak.lock();
+            if (!s) return;
+            {
+                std::lock_guard<std::mutex> lock(s->mutex);
+                if (s->settled) return;
+                ++s->busy;
+            }
+            withdraw();
+            s->leave();
+        }
+
+        // A thread done with the client for this call
+        void leave() {
+            bool arrive;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                arrive = --busy == 0 && deferred;
+                if (arrive) deferred = false;
+            }
+            if (arrive) this->arrive();
+        }
+
+        // The deadline or the token, at any stage
+        static void stop(const std::weak_ptr<CallState>& weak, Stop how) {
+            const auto s = weak.lock();
+            if (!s) return;
+            std::unique_lock<std::mutex> lock(s->mutex);
+            switch (s->stage) {
+                case Stage::Waiting:
+                    if (TimerQueue::shared().cancel(*s->due)) {
+                        s->stage = Stage::Failed;
+                        lock.unlock();
+                        s->fail(std::make_exception_ptr(how.error), true);
+                        return;
+                    }
+                    break;
+                case Stage::Queued:
+                    if (s->client->limiter.withdraw(s->ticket, how.expired)) {
+                        s->stage = Stage::Failed;
+                        lock.unlock();
+                        s->fail(std::make_exception_ptr(how.error), true);
+                        return;
+                    }
+                    break;
+                case Stage::Queuing:
+                case Stage::Sending:
+                    break;
+                case Stage::Sent: {
+                    const int requestId = s->requestId;
+                    lock.unlock();
+                    guard(weak, [&] {
+                        s->client->withdraw(requestId, how.reason, how.error, how.outcome, how.expired);
+                    });
+                    return;
+                }
+                case Stage::Failed:
+                    return;
+            }
+            if (!s->stopped) {
+                s->stopped = std::move(how);
+            }
+        }
+
+        // The rate limit tokens are due: take a turn in the limiter
+        static void queue(const std::shared_ptr<CallState>& s) {
+            std::unique_lock<std::mutex> lock(s->mutex);
+            s->due.reset();
+            if (s->stopped) {
+                s->stage = Stage::Failed;
+                lock.unlock();
+                s->fail(std::make_exception_ptr(s->stopped->error), true);
+                return;
+            }
+            s->stage = Stage::Queuing;
+            lock.unlock();
+            uint64_t ticket = 0;
+            const auto admission = s->client->limiter.acquireAsync(
+                s->deadline, s->options.priority, [s](bool granted) { turn(s, granted); }, &ticket);
+            switch (admission) {
+                case ConcurrencyLimiter::Admission::Granted:
+                    turn(s, true);
+                    return;
+                case ConcurrencyLimiter::Admission::Shed:
+                    turn(s, false);
+                    return;
+                case ConcurrencyLimiter::Admission::Queued:
+                    break;
+            }
+            lock.lock();
+            if (s->stage != Stage::Queuing) {
+                return;  // already granted or shed
+            }
+            s->stage = Stage::Queued;
+            s->ticket = ticket;
+            if (s->stopped && s->client->limiter.withdraw(ticket, s->stopped->expired)) {
+                s->stage = Stage::Failed;
+                lock.unlock();
+                s->fail(std::make_exception_ptr(s->stopped->error), true);
+            }
+        }
+
+        // The limiter's answer. A queued answer comes on the thread that
+        // freed the slot, often the transport's, so the send moves to the
+        // executor.
+        static void turn(const std::shared_ptr<CallState>& s, bool granted) {
+            auto go = [s, granted] {
+                std::unique_lock<std::mutex> lock(s->mutex);
+                if (s->stopped || !granted) {
+                    s->stage = Stage::Failed;
+                    lock.unlock();
+                    if (granted) {
+                        s->client->limiter.release(std::chrono::steady_clock::duration::zero(),
+                                                   ConcurrencyLimiter::Outcome::Ignore);
+                    }
+                    s->fail(s->stopped ? std::make_exception_ptr(s->stopped->error)
+                                       : std::make_exception_ptr(mcp::shedError(s->request.method)),
+                            true);
+                    return;
+                }
+                s->stage = Stage::Sending;
+                lock.unlock();
+                send(s);
+            };
+            if (!s->executor->trySubmit(go)) {
+                go();
+            }
+        }
+
+        // Sends a request admitted after suspending. Counted busy until the
+        // future is stored, so a quick answer does not resume the call first;
+        // a stop that came meanwhile is applied at once.
+        static void send(const std::shared_ptr<CallState>& s) {
+            {
+                std::lock_guard<std::mutex> lock(s->mutex);
+                ++s->busy;
+            }
+            std::optional<Stop> stop;
+            try {
+                auto [requestId, future] =
+                    s->client->sendAdmitted(s->request.method, s->request.params, sending(s), s->deadline,
+                                            s->request.outputSchema, s->request.tool);
+                std::lock_guard<std::mutex> lock(s->mutex);
+                s->future = std::move(future);
+                s->requestId = requestId;
+                s->stage = Stage::Sent;
+                stop.swap(s->stopped);
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(s->mutex);
+                    s->stage = Stage::Failed;
+                    --s->busy;
+                }
+                s->fail(std::current_exception(), false);
+                return;
+            }
+            if (stop) {
+                s->client->withdraw(s->requestId, stop->reason, stop->error, stop->outcome, stop->expired);
+            }
+            s->leave();
+        }
+
+        // The options a request goes out with: settling it resumes the call
+        static CallOptions sending(const std::shared_ptr<CallState>& s) {
+            CallOptions sent = s->options;
+            sent.onSettled = [s, settled = std::move(sent.onSettled)] {
+                if (settled) settled();
+                s->settle();
+            };
+            return sent;
+        }
+
+        // Failed before it was sent: resume with `error`, the rate limit
+        // tokens given back unless the client already did
+        void fail(std::exception_ptr error, bool refund) {
+            if (refund) {
+                client->rateLimits.refund(request.tool);
+            }
+            failed = std::move(error);
+            arrive();
+        }
+
+        void settle() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                settled = true;
+                if (busy > 0) {
+                    deferred = true;
+                    return;
+                }
+            }
+            arrive();
+        }
+
+        void arrive() {
+            if (arrivals.fetch_add(1, std::memory_order_acq_rel) == 1) {
+                resume();
+            }
+        }
+
+        void disarm() {
+            if (timer) {
+                TimerQueue::shared().cancel(*timer);
+                timer.reset();
+            }
+            cancel.unsubscribe(subscription);
+            subscription = 0;
+        }
+
+        void resume() {
+            auto h = awaiting;
+            if (!executor->trySubmit([h] { h.resume(); })) {
+                h.resume();
+            }
+        }
+    };
+
+public:
+    class CallAwaitable {
+        AsyncClient* owner;
+        std::string method;
+        CallOptions options;
+        CancellationToken cancel;
+        Prepare prepare;
+        std::shared_ptr<CallState> state;
+
+    public:
+        CallAwaitable(AsyncClient* owner, std::string method, CallOptions options, CancellationToken cancel,
+                      Prepare prepare)
+            : owner(owner), method(std::move(method)), options(std::move(options)), cancel(std::move(cancel)),
+              prepare(std::move(prepare)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        // Returns false, continuing at once, if the call settled (or failed)
+        // while it was being sent; throws what the checks before sending
+        // throw, and what the send throws when it goes at once
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            using Stage = CallState::Stage;
+            if (cancel.cancelled()) {
+                throw RpcError(JsonRpc::RequestCancelled, "Request cancelled");
+            }
+            mcp* client = &owner->client;
+            state = std::make_shared<CallState>();
+            state->client = client;
+            state->awaiting = awaiting;
+            state->executor = owner->executor;
+            state->cancel = cancel;
+            state->options = options;
+            state->deadline = client->deadlineFor(options);
+            state->request = prepare(options);
+
+            const auto wait = client->admit(state->request.method, state->deadline, state->request.tool);
+            if (wait > std::chrono::steady_clock::duration::zero()) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->stage = Stage::Waiting;
+                state->due = TimerQueue::shared().at(std::chrono::steady_clock::now() + wait, [s = state] {
+                    if (!s->executor->trySubmit([s] { CallState::queue(s); })) {
+                        CallState::queue(s);
+                    }
+                });
+            } else {
+                state->stage = Stage::Queuing;
+                uint64_t ticket = 0;
+                const auto admission = client->limiter.acquireAsync(
+                    state->deadline, options.priority,
+                    [s = state](bool granted) { CallState::turn(s, granted); }, &ticket);
+                switch (admission) {
+                    case ConcurrencyLimiter::Admission::Granted: {
+                        state->stage = Stage::Sending;
+                        auto [requestId, future] = client->sendAdmitted(
+                            state->request.method, state->request.params, CallState::sending(state), state->deadline,
+                            state->request.outputSchema, state->request.tool);
+                        state->future = std::move(future);
+                        state->requestId = requestId;
+                        state->stage = Stage::Sent;
+                        break;
+                    }
+                    case ConcurrencyLimiter::Admission::Shed:
+                        client->rateLimits.refund(state->request.tool);
+                        throw mcp::shedError(state->request.method);
+                    case ConcurrencyLimiter::Admission::Queued: {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        if (state->stage == Stage::Queuing) {
+                            state->stage = Stage::Queued;
+                            state->ticket = ticket;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            // The timer and the token may fire after the call resumed, when
+            // the client may be gone: both go through CallState::stop
+            auto pool = owner->executor;
+            std::weak_ptr<CallState> weak = state;
+            state->timer = TimerQueue::shared().at(state->deadline, [weak, pool, method = method] {
+                auto expire = [weak, method] {
+                    CallState::stop(weak, {"Request timed out",
+                                           RpcError(JsonRpc::RequestTimeout, "Request timed out: " + method),
+                                           ConcurrencyLimiter::Outcome::Overload, true});
+                };
+                if (!pool->trySubmit(expire)) {
+                    expire();
+                }
+            });
+            state->subscription = cancel.subscribe([weak](const std::string& reason) {
+                CallState::stop(weak, {reason, RpcError(JsonRpc::RequestCancelled, "Request cancelled"),
+                                       ConcurrencyLimiter::Outcome::Ignore, false});
+            });
+
+            if (state->arrivals.fetch_add(1, std::memory_order_acq_rel) == 1) {
+                state->disarm();
+                return false;
+            }
+            return true;
+        }
+
+        nlohmann::json await_resume() {
+            state->disarm();
+            if (state->failed) {
+                std::rethrow_exception(state->failed);
+            }
+            return state->future.get();
+        }
+    };
+
+    explicit AsyncClient(mcp& client, std::shared_ptr<Executor> executor = Executor::shared())
+        : client(client), executor(std::move(executor)) {}
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    CallAwaitable call(std::string method, nlohmann::json params, CallOptions options = {},
+                       CancellationToken cancel = {}) {
+        Prepare prepare = [method, params = std::move(params)](const CallOptions&) mutable {
+            return mcp::Outgoing{method, std::move(params), nullptr, {}};
+        };
+        return CallAwaitable(this, std::move(method), std::move(options), std::move(cancel), std::move(prepare));
+    }
+
+    // tools/call, with callTool()'s argument and output validation
+    CallAwaitable callTool(type::Symbol name, nlohmann::json arguments, CallOptions options = {},
+                           CancellationToken cancel = {}) {
+        mcp* c = &client;
+        Prepare prepare = [c, name, arguments = std::move(arguments)](const CallOptions& o) {
+            return c->toolCall(name, arguments, o);
+        };
+        return CallAwaitable(this, std::string(type::CallToolRequest::Method), std::move(options), std::move(cancel),
+                             std::move(prepare));
+    }
+
+    // Every page of the list, fetched one after the other. Listing tools
+    // also compiles their inputSchemas for callTool and, with
+    // config.cacheToolList, refreshes cachedTools().
+    Task<std::vector<type::Tool>> listTools(CallOptions options = {}, CancellationToken cancel = {}) {
+        return list<type::ListToolsRequest>(std::move(options), std::move(cancel));
+    }
+
+    Task<std::vector<type::Prompt>> listPrompts(CallOptions options = {}, CancellationToken cancel = {}) {
+        return list<type::ListPromptsRequest>(std::move(options), std::move(cancel));
+    }
+
+    Task<std::vector<type::Resource>> listResources(CallOptions options = {}, CancellationToken cancel = {}) {
+        return list<type::ListResourcesRequest>(std::move(options), std::move(cancel));
+    }
+
+    Task<std::vector<type::ResourceTemplate>> listResourceTemplates(CallOptions options = {},
+                                                                    CancellationToken cancel = {}) {
+        return list<type::ListResourceTemplatesRequest>(std::move(options), std::move(cancel));
+    }
+
+private:
+    template <class Request>
+    Task<std::vector<typename ListTraits<Request>::Item>> list(CallOptions options, CancellationToken cancel) {
+        using Traits = ListTraits<Request>;
+        std::vector<typename Traits::Item> items;
+        boost::optional<type::Cursor> cursor;
+        [[maybe_unused]] const uint64_t version = client.toolListSeen();
+        do {
+            nlohmann::json params = nlohmann::json::object();
+            if (cursor) {
+                params["cursor"] = *cursor;
+            }
+            auto page = co_await call(std::string(Request::Method), std::move(params), options, cancel);
+            auto result = page.template get<typename Traits::Result>();
+            if constexpr (std::is_same_v<Request, type::ListToolsRequest>) {
+                client.toolValidators.add(result.tools);
+            }
+            auto& batch = result.*Traits::items;
+            items.insert(items.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+            cursor = result.nextCursor && !result.nextCursor->empty() ? result.nextCursor : boost::none;
+        } while (cursor);
+        if constexpr (std::is_same_v<Request, type::ListToolsRequest>) {
+            std::vector<std::string> listed;
+            listed.reserve(items.size());
+            for (const auto& tool : items) {
+                listed.push_back(tool.name);
+            }
+            client.toolValidators.retain(listed);
+            if (client.config.cacheToolList) {
+                auto catalog = std::make_shared<type::ToolCatalog>();
+                catalog->append(items);
+                client.cacheTools(std::move(catalog), version);
+            }
+        }
+        co_return items;
+    }
+};
+
+} // namespace mcp
+
+#endif
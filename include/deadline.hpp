@@ -0,0 +1,91 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace mcp {
+
+// ============================================================================
+// Deadlines
+// ============================================================================
+//
+// A call's deadline travels upstream in the request's params._meta as the
+// time left, in whole milliseconds, under DeadlineMetaKey:
+//
+//     {"method": "tools/call", "params": {"name": "search", "arguments": {...},
+//      "_meta": {"mcpjamesplusplus/timeoutMs": 850}}}
+//
+// The value is relative because the hops do not share a clock. A receiver
+// turns it back into a local deadline on arrival (deadlineFromMeta) and
+// makes it the ambient deadline of the thread that handles the request
+// (DeadlineScope); calls made from there default to it and send what is
+// left of it, less each hop's margin, so the budget shrinks along a chain.
+// The Dispatcher does this for server-initiated requests.
+
+using Deadline = std::chrono::steady_clock::time_point;
+
+constexpr std::string_view DeadlineMetaKey = "mcpjamesplusplus/timeoutMs";
+
+// No deadline
+constexpr Deadline NoDeadline = Deadline::max();
+
+// Longest budget taken from a peer; larger values are clamped to it
+constexpr int64_t MaxDeadlineMs = 24 * 60 * 60 * 1000;
+
+namespace detail {
+inline Deadline& ambientDeadline() {
+    thread_local Deadline deadline = NoDeadline;
+    return deadline;
+}
+} // namespace detail
+
+// Deadline of the request this thread is handling, or NoDeadline
+inline Deadline currentDeadline() {
+    return detail::ambientDeadline();
+}
+
+// Makes `deadline` the ambient deadline until the end of the scope. Scopes
+// nest; an inner scope can only tighten the deadline.
+class DeadlineScope {
+    Deadline previous;
+
+public:
+    explicit DeadlineScope(Deadline deadline) : previous(detail::ambientDeadline()) {
+        detail::ambientDeadline() = std::min(previous, deadline);
+    }
+    ~DeadlineScope() { detail::ambientDeadline() = previous; }
+
+    DeadlineScope(const DeadlineScope&) = delete;
+    DeadlineScope& operator=(const DeadlineScope&) = delete;
+};
+
+// Local deadline from a request's params, measured from `received`;
+// NoDeadline if the sender did not set one
+inline Deadline deadlineFromMeta(const nlohmann::json& params, Deadline received) {
+    if (!params.is_object()) return NoDeadline;
+    const auto meta = params.find("_meta");
+    if (meta == params.end() || !meta->is_object()) return NoDeadline;
+    const auto it = meta->find(DeadlineMetaKey);
+    if (it == meta->end() || !it->is_number()) return NoDeadline;
+    // Clamped before converting: get<int64_t>() of a huge double is undefined
+    int64_t ms = 0;
+    if (it->is_number_unsigned()) {
+        ms = static_cast<int64_t>(std::min<uint64_t>(it->get<uint64_t>(), MaxDeadlineMs));
+    } else if (it->is_number_integer()) {
+        ms = std::clamp<int64_t>(it->get<int64_t>(), 0, MaxDeadlineMs);
+    } else {
+        const double d = it->get<double>();
+        ms = d > 0 ? static_cast<int64_t>(std::min<double>(d, MaxDeadlineMs)) : 0;
+    }
+    return received + std::chrono::milliseconds(ms);
+}
+
+// Milliseconds left before `deadline`, rounded down, never negative
+inline int64_t remainingMs(Deadline deadline, Deadline now) {
+    if (deadline <= now) return 0;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+}
+
+} // namespace mcp
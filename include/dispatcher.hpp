@@ -0,0 +1,268 @@
+#pragma once
+#include "type/schema.hpp"
+#include "type/schema_serialization.hpp"
+#include "jsonrpc.hpp"
+#include "deadline.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+
+namespace mcp {
+
+// ============================================================================
+// Compile-time method table
+// ============================================================================
+//
+// Perfect hash over the Method strings of the schema structs. The seed is
+// searched at compile time so that every method lands in its own slot; a
+// lookup is one hash, one table load and one string compare to reject
+// unknown methods.
+
+namespace detail {
+
+constexpr uint32_t methodHash(std::string_view s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+} // namespace detail
+
+template <class... Messages>
+class MethodTable {
+public:
+    static constexpr size_t Count = sizeof...(Messages);
+    static constexpr size_t Slots = 64;
+    static constexpr uint8_t Empty = 0xFF;
+    static_assert(Count * 2 <= Slots, "MethodTable: too many methods for the slot table");
+
+    static constexpr std::array<std::string_view, Count> names{Messages::Method...};
+
+private:
+    static constexpr bool collisionFree(uint32_t seed) {
+        std::array<bool, Slots> used{};
+        for (size_t i = 0; i < Count; ++i) {
+            auto slot = detail::methodHash(names[i], seed) & (Slots - 1);
+            if (used[slot]) return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    static constexpr uint32_t findSeed() {
+        for (uint32_t seed = 0; seed < 100000; ++seed) {
+            if (collisionFree(seed)) return seed;
+        }
+        return UINT32_MAX;
+    }
+
+    static constexpr std::array<uint8_t, Slots> buildSlots(uint32_t seed) {
+        std::array<uint8_t, Slots> slots{};
+        for (auto& s : slots) s = Empty;
+        for (size_t i = 0; i < Count; ++i) {
+            slots[detail::methodHash(names[i], seed) & (Slots - 1)] = static_cast<uint8_t>(i);
+        }
+        return slots;
+    }
+
+public:
+    static constexpr uint32_t seed = findSeed();
+    static_assert(seed != UINT32_MAX, "MethodTable: no collision-free seed found");
+    static constexpr std::array<uint8_t, Slots> slots = buildSlots(seed);
+
+    // Returns the index of the method, or -1 if it is not in the table
+    static constexpr int indexOf(std::string_view method) {
+        const auto i = slots[detail::methodHash(method, seed) & (Slots - 1)];
+        return (i != Empty && names[i] == method) ? i : -1;
+    }
+
+    template <class T>
+    static constexpr size_t index() {
+        constexpr bool matches[] = {std::is_same_v<T, Messages>...};
+        for (size_t i = 0; i < Count; ++i) {
+            if (matches[i]) return i;
+        }
+        return Count;
+    }
+};
+
+// ============================================================================
+// Inbound requests and notifications
+// ============================================================================
+
+// Result type for each server-initiated request; notifications have none
+template <class T> struct RequestResult { using type = void; };
+template <> struct RequestResult<type::PingRequest> { using type = type::EmptyResult; };
+template <> struct RequestResult<type::CreateMessageRequest> { using type = type::CreateMessageResult; };
+template <> struct RequestResult<type::ListRootsRequest> { using type = type::ListRootsResult; };
+template <> struct RequestResult<type::ElicitRequest> { using type = type::ElicitResult; };
+
+using InboundMethods = MethodTable<
+    type::PingRequest,
+    type::CreateMessageRequest,
+    type::ListRootsRequest,
+    type::ElicitRequest,
+    type::CancelledNotification,
+    type::ProgressNotification,
+    type::LoggingMessageNotification,
+    type::ResourceUpdatedNotification,
+    type::ResourceListChangedNotification,
+    type::ToolListChangedNotification,
+    type::PromptListChangedNotification>;
+
+class Dispatcher {
+public:
+    using Sender = std::function<void(const std::string&)>;
+    // id is null for notifications
+    using RawHandler = std::function<void(const nlohmann::json& id, const nlohmann::json& params)>;
+    // Runs a request handler off the I/O thread; returns false when full
+    using Submit = std::function<bool(std::function<void()>)>;
+
+private:
+    std::array<RawHandler, InboundMethods::Count> handlers;
+    Sender send;
+    Submit submit;
+
+    template <class T>
+    static void parseParams(const nlohmann::json& params, T& message) {
+        using P = std::decay_t<decltype(message.params)>;
+        if constexpr (std::is_same_v<P, boost::optional<std::map<std::string, nlohmann::json>>>) {
+            if (params.is_object()) {
+                message.params = params.get<std::map<std::string, nlohmann::json>>();
+            }
+        } else {
+            params.get_to(message.params);
+        }
+    }
+
+    template <class R>
+    static nlohmann::json resultToJson(const R& result) {
+        if constexpr (std::is_same_v<R, type::EmptyResult>) {
+            nlohmann::json j = nlohmann::json::object();
+            if (result._meta) j["_meta"] = *result._meta;
+            return j;
+        } else {
+            return result;
+        }
+    }
+
+    void reply(const nlohmann::json& id, const std::string& message) {
+        if (!id.is_null() && send) {
+            send(message);
+        }
+    }
+
+public:
+    explicit Dispatcher(Sender sender = nullptr)
+        : send(std::move(sender)) {
+        // Servers may ping at any time; answer with an empty result by default
+        on<type::PingRequest>([](const type::PingRequest&) { return type::EmptyResult{}; });
+    }
+
+    Dispatcher(const Dispatcher&) = delete;
+    Dispatcher& operator=(const Dispatcher&) = delete;
+
+    void setSender(Sender sender) {
+        send = std::move(sender);
+    }
+
+    // Request handlers (except ping) are parsed on the I/O thread and then
+    // run through `submit`; without one they run inline.
+    void setSubmit(Submit s) {
+        submit = std::move(s);
+    }
+
+    // Registers a typed handler. Requests return their RequestResult type,
+    // notifications return void. Register handlers before the transport is
+    // started: the table is read without locking from the listener thread.
+    template <class T, class Handler>
+    void on(Handler handler) {
+        constexpr auto slot = InboundMethods::index<T>();
+        static_assert(slot < InboundMethods::Count, "Dispatcher::on: method is not an inbound method");
+        using Result = typename RequestResult<T>::type;
+
+        auto shared = std::make_shared<Handler>(std::move(handler));
+        handlers[slot] = [this, shared](const nlohmann::json& id, const nlohmann::json& params) {
+            T message;
+            try {
+                parseParams(params, message);
+            } catch (const std::exception& e) {
+                reply(id, JsonRpc::serializeError(id, JsonRpc::InvalidParams, e.what()));
+                return;
+            }
+
+            if constexpr (std::is_void_v<Result>) {
+                (*shared)(message);
+            } else {
+                // Calls the handler makes inherit the sender's deadline,
+                // counted from arrival rather than from when it runs
+                const Deadline deadline = deadlineFromMeta(params, std::chrono::steady_clock::now());
+                auto run = [this, shared, id, deadline, message = std::move(message)]() {
+                    DeadlineScope scope(deadline);
+                    try {
+                        Result result = (*shared)(message);
+                        reply(id, JsonRpc::serializeResult(id, resultToJson(result)));
+                    } catch (const std::exception& e) {
+                        reply(id, JsonRpc::serializeError(id, JsonRpc::InternalError, e.what()));
+                    }
+                };
+
+                if (!submit || std::is_same_v<T, type::PingRequest>) {
+                    run();
+                } else if (!submit(std::move(run))) {
+                    reply(id, JsonRpc::serializeError(id, JsonRpc::ServerBusy, "Too many concurrent requests"));
+                }
+            }
+        };
+    }
+
+    // Registers an untyped handler, e.g. to forward a method as raw json
+    template <class T>
+    void onRaw(RawHandler handler) {
+        constexpr auto slot = InboundMethods::index<T>();
+        static_assert(slot < InboundMethods::Count, "Dispatcher::onRaw: method is not an inbound method");
+        handlers[slot] = std::move(handler);
+    }
+
+    // Handles one inbound message that carries a "method" member.
+    // Returns false if no handler is registered for it.
+    bool dispatch(const nlohmann::json& message) {
+        const auto& method = message.at("method").get_ref<const std::string&>();
+        const auto it = message.find("id");
+        const nlohmann::json& id = it != message.end() ? *it : nullJson();
+        const auto pit = message.find("params");
+        const nlohmann::json& params = pit != message.end() ? *pit : emptyObject();
+
+        const int slot = InboundMethods::indexOf(method);
+        if (slot < 0 || !handlers[slot]) {
+            if (!id.is_null()) {
+                reply(id, JsonRpc::serializeError(id, JsonRpc::MethodNotFound, "Method not found: " + method));
+            } else {
+                std::cout << "[MCP] Unhandled notification: " << method << std::endl;
+            }
+            return false;
+        }
+
+        handlers[slot](id, params);
+        return true;
+    }
+
+private:
+    static const nlohmann::json& nullJson() {
+        static const nlohmann::json j;
+        return j;
+    }
+
+    static const nlohmann::json& emptyObject() {
+        static const nlohmann::json j = nlohmann::json::object();
+        return j;
+    }
+};
+
+} // namespace mcp
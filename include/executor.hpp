@@ -0,0 +1,302 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mcp {
+
+// ============================================================================
+// Executor
+// ============================================================================
+//
+// Bounded work-stealing thread pool. Each worker owns a deque: it pops its
+// own work LIFO and steals FIFO from the others when idle. Tasks submitted
+// from outside the pool are spread round-robin. trySubmit() rejects instead
+// of blocking once `capacity` tasks are queued, so the I/O thread never
+// stalls on a busy pool.
+
+class Executor {
+public:
+    using Task = std::function<void()>;
+
+    struct Metrics {
+        size_t queued = 0;
+        size_t running = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;
+        uint64_t stolen = 0;
+    };
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    const size_t capacity;
+
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> running{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> stolen{0};
+    std::atomic<size_t> nextWorker{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static size_t& currentWorker() {
+        static thread_local size_t index = SIZE_MAX;
+        return index;
+    }
+
+    bool take(size_t self, Task& task) {
+        {
+            auto& own = *workers[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < workers.size(); ++i) {
+            auto& victim = *workers[(self + i) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        currentWorker() = self;
+        Task task;
+        while (true) {
+            if (take(self, task)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                running.fetch_add(1, std::memory_order_relaxed);
+                try {
+                    task();
+                } catch (...) {
+                    // Tasks report their own errors; keep the worker alive
+                }
+                task = nullptr;
+                running.fetch_sub(1, std::memory_order_relaxed);
+                completed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit Executor(size_t threadCount = std::max(2u, std::thread::hardware_concurrency()),
+                      size_t capacity = 1024)
+        : capacity(capacity) {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    // Runs the tasks already queued, then joins the workers
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    bool trySubmit(Task task) {
+        if (queued.fetch_add(1) >= capacity) {
+            queued.fetch_sub(1);
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Work spawned from a worker stays local; the rest is spread out
+        size_t target = currentWorker();
+        if (target >= workers.size()) {
+            target = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        }
+        {
+            auto& w = *workers[target];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            w.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+        return true;
+    }
+
+    Metrics metrics() const {
+        Metrics m;
+        m.queued = queued.load(std::memory_order_relaxed);
+        m.running = running.load(std::memory_order_relaxed);
+        m.completed = completed.load(std::memory_order_relaxed);
+        m.rejected = rejected.load(std::memory_order_relaxed);
+        m.stolen = stolen.load(std::memory_order_relaxed);
+        return m;
+    }
+
+    size_t threadCount() const {
+        return threads.size();
+    }
+
+    // Process-wide pool used when a client is not given one explicitly
+    static std::shared_ptr<Executor> shared() {
+        static std::shared_ptr<Executor> instance = std::make_shared<Executor>();
+        return instance;
+    }
+};
+
+// ============================================================================
+// BoundedLane
+// ============================================================================
+//
+// Per-server view of an Executor: at most `maxConcurrent` of this server's
+// tasks run at once, up to `maxQueued` more wait in the lane, the rest are
+// rejected. The destructor drops waiting tasks and blocks until the running
+// ones finish, so tasks may safely reference the owner of the lane.
+
+class BoundedLane {
+public:
+    using Task = Executor::Task;
+
+    struct Metrics {
+        size_t queued = 0;
+        size_t running = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;
+    };
+
+private:
+    std::shared_ptr<Executor> executor;
+    const size_t maxConcurrent;
+    const size_t maxQueued;
+
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::deque<Task> pending;
+    size_t running = 0;
+    uint64_t completed = 0;
+    uint64_t rejected = 0;
+    bool closed = false;
+
+    // Called with the lock held; the slot is already accounted in `running`.
+    // The task keeps its slot and drains waiting tasks inline before
+    // releasing it, so accepted work is never dropped.
+    bool launch(Task task) {
+        auto wrapped = [this, task = std::move(task)]() mutable {
+            runGuarded(task);
+            drain();
+        };
+        return executor->trySubmit(std::move(wrapped));
+    }
+
+    static void runGuarded(Task& task) {
+        try {
+            task();
+        } catch (...) {
+        }
+    }
+
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++completed;
+        while (!closed && !pending.empty()) {
+            Task next = std::move(pending.front());
+            pending.pop_front();
+            lock.unlock();
+            runGuarded(next);
+            lock.lock();
+            ++completed;
+        }
+        --running;
+        if (running == 0) {
+            idle.notify_all();
+        }
+    }
+
+public:
+    BoundedLane(std::shared_ptr<Executor> executor, size_t maxConcurrent, size_t maxQueued)
+        : executor(std::move(executor)),
+          maxConcurrent(std::max<size_t>(maxConcurrent, 1)),
+          maxQueued(maxQueued) {}
+
+    ~BoundedLane() {
+        std::unique_lock<std::mutex> lock(mutex);
+        closed = true;
+        pending.clear();
+        idle.wait(lock, [this] { return running == 0; });
+    }
+
+    BoundedLane(const BoundedLane&) = delete;
+    BoundedLane& operator=(const BoundedLane&) = delete;
+
+    bool trySubmit(Task task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) {
+            return false;
+        }
+        if (running < maxConcurrent) {
+            ++running;
+            if (launch(std::move(task))) {
+                return true;
+            }
+            --running;
+            ++rejected;
+            return false;
+        }
+        if (pending.size() < maxQueued) {
+            pending.push_back(std::move(task));
+            return true;
+        }
+        ++rejected;
+        return false;
+    }
+
+    Metrics metrics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Metrics m;
+        m.queued = pending.size();
+        m.running = running;
+        m.completed = completed;
+        m.rejected = rejected;
+        return m;
+    }
+};
+
+} // namespace mcp
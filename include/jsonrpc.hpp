@@ -1,13 +1,16 @@
 #pragma once
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <nlohmann/json.hpp>
+#include "type/schema_writer.hpp"
 
 namespace mcp {
 
 struct JsonRpcRequest {
     std::string jsonrpc = "2.0";
     int id;
-    std::string method;
+    type::Symbol method;
     nlohmann::json params;
 };
 
@@ -18,31 +21,129 @@ struct JsonRpcResponse {
     nlohmann::json error;
 };
 
+// Error reply from the server, or a local failure (timeout, transport) with
+// one of the JsonRpc error codes
+class RpcError : public std::runtime_error {
+public:
+    int code;
+    nlohmann::json data;
+
+    RpcError(int code, const std::string& message, nlohmann::json data = nullptr)
+        : std::runtime_error(message), code(code), data(std::move(data)) {}
+
+    static RpcError fromJson(const nlohmann::json& error) {
+        return RpcError(error.value("code", 0), error.value("message", std::string("Unknown error")),
+                        error.value("data", nlohmann::json()));
+    }
+};
+
 class JsonRpc {
 public:
-    static inline std::string serializeRequest(const JsonRpcRequest& req) {
-        nlohmann::json j;
-        j["jsonrpc"] = req.jsonrpc;
-        j["id"] = req.id;
-        j["method"] = req.method;
-        
-        if (!req.params.is_null()) {
-            j["params"] = req.params;
+    static constexpr int ParseError = -32700;
+    static constexpr int InvalidRequest = -32600;
+    static constexpr int MethodNotFound = -32601;
+    static constexpr int InvalidParams = -32602;
+    static constexpr int InternalError = -32603;
+    // Implementation-defined server error: handler queue full
+    static constexpr int ServerBusy = -32000;
+    // Local errors, never sent on the wire
+    static constexpr int RequestTimeout = -32001;
+    static constexpr int ConnectionClosed = -32002;
+    // structuredContent does not match the tool's outputSchema
+    static constexpr int InvalidOutput = -32003;
+    // The server's circuit breaker is open; the request was not sent
+    static constexpr int CircuitOpen = -32004;
+    // The caller withdrew the request (notifications/cancelled was sent)
+    static constexpr int RequestCancelled = -32005;
+    // Shed by the concurrency limiter; the request was not sent
+    static constexpr int Overloaded = -32006;
+    // Over a configured rate limit; the request was not sent
+    static constexpr int RateLimited = -32007;
+    // Too little of the call's deadline left to send it
+    static constexpr int DeadlineExceeded = -32008;
+    // The transport could not deliver the request; data has the HTTP
+    // status (0: none), whether it may have been delivered and any
+    // Retry-After (see TransportError)
+    static constexpr int TransportFailed = -32009;
+
+    // Writes the envelope straight to bytes; params may be a nlohmann::json or
+    // any reflected schema struct (e.g. type::InitializeRequest::Params).
+    template <class P>
+    static inline void writeRequest(type::WriteBuffer& out, int id, std::string_view method, const P& params) {
+        type::writeRaw(out, "{\"jsonrpc\":\"2.0\",\"id\":");
+        type::writeRaw(out, fmt::format_int(id).c_str());
+        type::writeRaw(out, ",\"method\":");
+        type::writeString(out, method);
+        if constexpr (std::is_same_v<P, nlohmann::json>) {
+            if (params.is_null()) {
+                out.push_back('}');
+                return;
+            }
         }
-        
-        return j.dump();
+        type::writeRaw(out, ",\"params\":");
+        type::writeValue(out, params);
+        out.push_back('}');
+    }
+
+    template <class P>
+    static inline std::string serializeRequest(int id, std::string_view method, const P& params) {
+        type::WriteBuffer out;
+        writeRequest(out, id, method, params);
+        return fmt::to_string(out);
+    }
+
+    static inline std::string serializeRequest(const JsonRpcRequest& req) {
+        return serializeRequest(req.id, req.method, req.params);
     }
 
     static inline std::string serializeResponse(const JsonRpcResponse& res) {
-        nlohmann::json j;
-        j["jsonrpc"] = res.jsonrpc;
-        j["id"] = res.id;
+        type::WriteBuffer out;
+        type::writeRaw(out, "{\"jsonrpc\":\"2.0\",\"id\":");
+        type::writeRaw(out, fmt::format_int(res.id).c_str());
         if (!res.error.is_null()) {
-            j["error"] = res.error;
+            type::writeRaw(out, ",\"error\":");
+            type::writeJson(out, res.error);
         } else {
-            j["result"] = res.result;
+            type::writeRaw(out, ",\"result\":");
+            type::writeJson(out, res.result);
         }
-        return j.dump();
+        out.push_back('}');
+        return fmt::to_string(out);
+    }
+
+    // Replies to a server-initiated request; id is echoed back verbatim
+    // since servers may use string ids.
+    static inline std::string serializeResult(const nlohmann::json& id, const nlohmann::json& result) {
+        type::WriteBuffer out;
+        type::writeRaw(out, "{\"jsonrpc\":\"2.0\",\"id\":");
+        type::writeJson(out, id);
+        type::writeRaw(out, ",\"result\":");
+        type::writeJson(out, result);
+        out.push_back('}');
+        return fmt::to_string(out);
+    }
+
+    static inline std::string serializeError(const nlohmann::json& id, int code, std::string_view message) {
+        type::WriteBuffer out;
+        type::writeRaw(out, "{\"jsonrpc\":\"2.0\",\"id\":");
+        type::writeJson(out, id);
+        type::writeRaw(out, ",\"error\":{\"code\":");
+        type::writeRaw(out, fmt::format_int(code).c_str());
+        type::writeRaw(out, ",\"message\":");
+        type::writeString(out, message);
+        type::writeRaw(out, "}}");
+        return fmt::to_string(out);
+    }
+
+    template <class P>
+    static inline std::string serializeNotification(std::string_view method, const P& params) {
+        type::WriteBuffer out;
+        type::writeRaw(out, "{\"jsonrpc\":\"2.0\",\"method\":");
+        type::writeString(out, method);
+        type::writeRaw(out, ",\"params\":");
+        type::writeValue(out, params);
+        out.push_back('}');
+        return fmt::to_string(out);
     }
 
     static inline JsonRpcRequest parseRequest(const std::string& data) {
@@ -50,13 +151,19 @@ public:
         JsonRpcRequest req;
         req.jsonrpc = j.value("jsonrpc", "2.0");
         req.id = j.value("id", 0);
-        req.method = j.value("method", "");
+        auto method = j.find("method");
+        if (method != j.end() && method->is_string()) {
+            req.method = method->get_ref<const std::string&>();
+        }
         req.params = j.value("params", nlohmann::json::object());
         return req;
     }
 
     static inline JsonRpcResponse parseResponse(const std::string& data) {
-        auto j = nlohmann::json::parse(data);
+        return parseResponse(nlohmann::json::parse(data));
+    }
+
+    static inline JsonRpcResponse parseResponse(const nlohmann::json& j) {
         JsonRpcResponse res;
         res.jsonrpc = j.value("jsonrpc", "2.0");
         res.id = j.value("id", 0);
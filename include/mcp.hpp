@@ -2,64 +2,1036 @@
 #include "type/mcp_type.hpp"
 #include "transport/transport.hpp"
 #include "jsonrpc.hpp"
+#include "dispatcher.hpp"
+#include "executor.hpp"
+#include "progress.hpp"
+#include "pagination.hpp"
+#include "circuit_breaker.hpp"
+#include "concurrency_limiter.hpp"
+#include "rate_limiter.hpp"
+#include "deadline.hpp"
+#include "retry_policy.hpp"
+#include "mpsc_queue.hpp"
+#include "type/schema_validator.hpp"
+#include "type/flat_tool.hpp"
+#include "type/structured.hpp"
+#include <algorithm>
 #include <memory>
 #include <chrono>
 #include <iostream>
 #include <regex>
 #include <mutex>
+#include <atomic>
+#include <future>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace mcp {
 
+struct CallOptions {
+    // Receives notifications/progress for this call, coalesced to at most
+    // one invocation per progressInterval
+    ProgressCallback onProgress;
+    std::chrono::milliseconds progressInterval{100};
+    // callTool: check arguments against the tool's compiled inputSchema
+    // (known once the tool list has been fetched) before sending
+    bool validateArguments = true;
+    // callTool: check structuredContent against the tool's compiled
+    // outputSchema before the result is handed out; a mismatch fails the
+    // call with RpcError(InvalidOutput)
+    bool validateOutput = false;
+    // Runs once the call's future is ready (result, error, cancellation or
+    // lost connection), on the thread that settled it; e.g. to wait on
+    // several calls at once. Must not block.
+    std::function<void()> onSettled;
+    // Lane in the concurrency limiter's queue, and order of re-sending
+    // after a reconnect. Interactive calls go High, bulk work Low.
+    Priority priority = Priority::Normal;
+    // When the caller gives up on the call. The earliest of this, the
+    // ambient deadline (see deadline.hpp) and requestTimeoutMs applies; it
+    // bounds the waits before sending and call(), and is sent upstream
+    // when config.propagateDeadlines is set.
+    Deadline deadline = NoDeadline;
+};
+
 class mcp {
-    std::string id;
+    type::Symbol id;
     type::McpServerConfig config;
     std::unique_ptr<Transport> transport;
-    type::ConnectionStatus status = type::ConnectionStatus::DISCONNECTED;
+    std::atomic<type::ConnectionStatus> status{type::ConnectionStatus::DISCONNECTED};
     std::chrono::steady_clock::time_point lastConnected;
-    int retryCount = 0;
+    std::atomic<int> retryCount{0};
+    type::ConnectionCallback statusCallback;
     
-    int nextId = 1;
+    std::atomic<int> nextId{1};
+    std::atomic<WireEncoding> encoding{WireEncoding::Json};
+
+    struct PendingCall {
+        std::promise<nlohmann::json> promise;
+        std::shared_ptr<ProgressThrottle> progress;
+        std::shared_ptr<const type::CompiledSchema> outputSchema;
+        // As sent, for re-sending after a reconnect that lost the session
+        std::string wire;
+        WireEncoding wireEncoding = WireEncoding::Json;
+        bool stamped = false;  // wire carries the deadline budget in _meta
+        Deadline deadline = NoDeadline;
+        std::chrono::steady_clock::time_point sentAt;
+        bool callerDeadline = false;  // the caller's deadline, not requestTimeoutMs, bounds the wait
+        bool held = false;  // waiting for the session to come back
+        bool sent = false;  // transport->send() returned before the drop
+        bool probe = false;
+        bool limited = false;  // holds a concurrency limiter slot
+        Priority priority = Priority::Normal;
+        std::function<void()> settled;
+    };
+    std::mutex pendingMutex;
+    std::unordered_map<int, PendingCall> pending;
+
+    // Compiled inputSchemas from the last tool listing
+    type::ToolValidators toolValidators;
+
+    // The last complete tool listing when config.cacheToolList is set.
+    // toolListVersion counts tools/list_changed, so a listing that
+    // straddles one is not cached.
+    mutable std::mutex toolCacheMutex;
+    std::shared_ptr<const type::ToolCatalog> toolCache;
+    uint64_t toolListVersion = 0;
+
+    CircuitBreaker breaker;
+    std::atomic<int> probeId{0};
+    ConcurrencyLimiter limiter;
+    RateLimits rateLimits;
+    RetryPolicy retry;
+
+    Dispatcher dispatcher;
+    std::unique_ptr<BoundedLane> handlerLane;
+    // Between the transport's thread and receive() when
+    // config.inboundQueueCapacity is set. The transport's thread pushes
+    // into it, so stop() and ~mcp() stop the transport before resetting it.
+    std::unique_ptr<DrainThread<Message>> inbound;
+    std::atomic<uint64_t> inboundDropped{0};
+    std::atomic<int64_t> inboundDropLogged{0};  // steady_clock ticks of the last drop log
+
+    // Awaits calls without blocking; see coroutine.hpp
+    friend class AsyncClient;
 
 public:
     explicit mcp(std::unique_ptr<Transport> t)
-        : transport(std::move(t)) {}
+        : mcp(std::move(t), type::McpServerConfig{}) {}
+
+    mcp(std::unique_ptr<Transport> t, const type::McpServerConfig& cfg,
+        std::shared_ptr<Executor> executor = Executor::shared())
+        : config(cfg), transport(std::move(t)), breaker(breakerOptions(cfg)), limiter(limiterOptions(cfg)),
+          retry(retryOptions(cfg)) {
+        rateLimits.limitServer(config.rateLimit.perSecond, config.rateLimit.burst);
+        for (const auto& [tool, limit] : config.toolRateLimits) {
+            rateLimits.limitTool(tool, limit.perSecond, limit.burst);
+        }
+        handlerLane = std::make_unique<BoundedLane>(std::move(executor),
+                                                    static_cast<size_t>(std::max(config.maxConcurrentHandlers, 1)),
+                                                    static_cast<size_t>(std::max(config.maxQueuedHandlers, 0)));
+        dispatcher.setSender([this](const std::string& msg) {
+            try {
+                transport->send(transcode(msg, encoding.load()));
+            } catch (const TransportError& e) {
+                std::cout << "[MCP] Reply not sent: " << e.what() << std::endl;
+            }
+        });
+        dispatcher.setSubmit([this](std::function<void()> task) { return handlerLane->trySubmit(std::move(task)); });
+        dispatcher.on<type::ProgressNotification>([this](const type::ProgressNotification& n) { routeProgress(n.params); });
+        dispatcher.on<type::ToolListChangedNotification>([this](const type::ToolListChangedNotification&) {
+            toolListChanged();
+        });
+    }
+
+    ~mcp() {
+        transport->stop();
+        inbound.reset();
+    }
+
+    // State of this server's circuit breaker, with the current window
+    CircuitBreaker::Metrics breakerMetrics() {
+        return breaker.metrics();
+    }
+
+    // Current adaptive concurrency limit, requests in flight and queued
+    ConcurrencyLimiter::Metrics limiterMetrics() {
+        return limiter.metrics();
+    }
+
+    // Retries made by call()/callTool(), and those refused by a budget
+    RetryPolicy::Metrics retryMetrics() const {
+        return retry.metrics();
+    }
+
+    // Calls refused by the server and tool rate limits so far
+    uint64_t rateLimited() const {
+        return rateLimits.rejected();
+    }
+
+    // The tools of the last listing read to the end, in the server's order,
+    // when config.cacheToolList is set; null before one completes and after
+    // notifications/tools/list_changed
+    std::shared_ptr<const type::ToolCatalog> cachedTools() const {
+        std::lock_guard<std::mutex> lock(toolCacheMutex);
+        return toolCache;
+    }
+
+    // Queue depth and throughput of this server's request handlers
+    BoundedLane::Metrics handlerMetrics() const {
+        return handlerLane->metrics();
+    }
+
+    // Registers a handler for a server-initiated request or notification,
+    // e.g. on<type::CreateMessageRequest>(...). Call before start().
+    template <class T, class Handler>
+    void on(Handler handler) {
+        if constexpr (std::is_same_v<T, type::ProgressNotification>) {
+            // Keep routing progress to per-call callbacks
+            dispatcher.on<T>([this, handler = std::move(handler)](const type::ProgressNotification& n) {
+                routeProgress(n.params);
+                handler(n);
+            });
+        } else if constexpr (std::is_same_v<T, type::ToolListChangedNotification>) {
+            // Keep invalidating the compiled tool schemas and cached tools
+            dispatcher.on<T>([this, handler = std::move(handler)](const type::ToolListChangedNotification& n) {
+                toolListChanged();
+                handler(n);
+            });
+        } else {
+            dispatcher.on<T>(std::move(handler));
+        }
+    }
+
+    // Switches to a binary encoding agreed during initialize, e.g.
+    // useEncoding(type::negotiateEncoding(preferred, result.capabilities)).
+    // Returns false, and keeps the current encoding, if the transport
+    // cannot carry it.
+    bool useEncoding(WireEncoding e) {
+        if (!transport->setEncoding(e)) {
+            return false;
+        }
+        encoding.store(e);
+        return true;
+    }
+
+    // Called on every transport connection change. Call before start().
+    void onConnectionStatus(type::ConnectionCallback callback) {
+        statusCallback = std::move(callback);
+    }
+
+    type::ConnectionStatus connectionStatus() const {
+        return status.load();
+    }
 
     void start() {
         std::cout << "[MCP] Starting transport and listening for responses..." << std::endl;
-        transport->start([this](const std::string& msg) {
-            std::cout << "\n[MCP] <<<< Received raw message: " << msg << std::endl;
-            
+        transport->onStatus([this](type::ConnectionStatus s) { statusChanged(s); });
+        if (config.inboundQueueCapacity <= 0) {
+            transport->start([this](Message&& msg) { receive(std::move(msg)); });
+            return;
+        }
+        // The transport's thread only enqueues, so a slow consumer does not
+        // stall socket reads until the queue is full
+        inbound = std::make_unique<DrainThread<Message>>(static_cast<size_t>(config.inboundQueueCapacity),
+                                                         static_cast<size_t>(std::max(config.inboundBatch, 1)),
+                                                         [this](Message&& msg) { receive(std::move(msg)); });
+        const bool drop = config.inboundOverflow == "drop";
+        transport->start([this, drop](Message&& msg) {
+            auto& queue = inbound->input();
+            if (drop ? queue.tryPush(std::move(msg)) : queue.push(std::move(msg))) {
+                return;
+            }
+            // Counted in droppedMessages(); logged at most once a second
+            // while the queue stays full, not per message
+            const auto n = ++inboundDropped;
+            const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+            auto last = inboundDropLogged.load(std::memory_order_relaxed);
+            if (now - last >= std::chrono::steady_clock::duration(std::chrono::seconds(1)).count() &&
+                inboundDropLogged.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+                std::cout << "[MCP] Inbound queue full, " << n << " message(s) dropped so far\n";
+            }
+        });
+    }
+
+    // Messages dropped because the inbound queue was full
+    uint64_t droppedMessages() const {
+        return inboundDropped.load();
+    }
+
+    // Sends a request and returns a future for its result. The future throws
+    // RpcError if the server answers with an error.
+    std::future<nlohmann::json> callAsync(const std::string& method, const nlohmann::json& params,
+                                          const CallOptions& options = {}) {
+        return sendRequest(method, params, options, deadlineFor(options)).second;
+    }
+
+    // Like callAsync, also returning the request id for cancel()
+    std::pair<int, std::future<nlohmann::json>> callWithId(const std::string& method, const nlohmann::json& params,
+                                                            const CallOptions& options = {}) {
+        return sendRequest(method, params, options, deadlineFor(options));
+    }
+
+    // Sends a request and waits up to config.requestTimeoutMs, or the
+    // call's deadline if that is sooner, for its result. With
+    // config.retryFailedCalls, failures are retried per RetryPolicy within
+    // that same deadline.
+    nlohmann::json call(const std::string& method, const nlohmann::json& params,
+                        const CallOptions& options = {}) {
+        const auto deadline = deadlineFor(options);
+        return withRetries(method, RetryPolicy::safeMethod(method), deadline, [&] {
+            auto [requestId, future] = sendRequest(method, params, options, deadline);
+            return await(requestId, future, method, deadline);
+        });
+    }
+
+    // tools/call. Arguments are validated locally when the tool's schema is
+    // known from listTools(); invalid ones throw RpcError(InvalidParams)
+    // without a round trip.
+    std::future<nlohmann::json> callToolAsync(type::Symbol name, const nlohmann::json& arguments,
+                                              const CallOptions& options = {}) {
+        return sendToolCall(name, arguments, options, deadlineFor(options)).second;
+    }
+
+    std::pair<int, std::future<nlohmann::json>> callToolWithId(type::Symbol name, const nlohmann::json& arguments,
+                                                                const CallOptions& options = {}) {
+        return sendToolCall(name, arguments, options, deadlineFor(options));
+    }
+
+    nlohmann::json callTool(type::Symbol name, const nlohmann::json& arguments, const CallOptions& options = {}) {
+        const auto deadline = deadlineFor(options);
+        const std::string method(type::CallToolRequest::Method);
+        return withRetries(method, toolValidators.find(name).idempotent, deadline, [&] {
+            auto [requestId, future] = sendToolCall(name, arguments, options, deadline);
+            return await(requestId, future, method, deadline);
+        });
+    }
+
+    // Sends notifications/cancelled for a request still in flight and fails
+    // its future with RpcError(RequestCancelled). A late response is dropped.
+    // Returns false if the request already completed.
+    bool cancel(int requestId, const std::string& reason = {}) {
+        return withdraw(requestId, reason, RpcError(JsonRpc::RequestCancelled, "Request cancelled"),
+                        ConcurrencyLimiter::Outcome::Ignore);
+    }
+
+    // Gives up on a request whose answer is no longer awaited, e.g. one
+    // from callWithId() that outlived its deadline: like cancel(), but it
+    // fails with RpcError(RequestTimeout) and counts as a timeout for the
+    // concurrency limiter and circuit breaker (see await()).
+    bool expire(int requestId, const std::string& reason = "Request timed out") {
+        return withdraw(requestId, reason, RpcError(JsonRpc::RequestTimeout, "Request timed out"),
+                        ConcurrencyLimiter::Outcome::Overload, true);
+    }
+
+    CircuitBreaker::State breakerState() const {
+        return breaker.current();
+    }
+
+    // Lazy ranges over every page of the list; see ListRange. The client
+    // must outlive the range. Listing tools also compiles their inputSchemas
+    // for callTool, and a listing read to the end drops the schemas of tools
+    // the server no longer lists (and, with config.cacheToolList, becomes
+    // cachedTools()); `observe` additionally sees each page of tools.
+    ListRange<type::ListToolsRequest> listTools(ListRange<type::ListToolsRequest>::Observer observe = {}) {
+        auto listed = std::make_shared<std::vector<std::string>>();
+        auto catalog = config.cacheToolList ? std::make_shared<type::ToolCatalog>() : nullptr;
+        const uint64_t version = toolListSeen();
+        return list<type::ListToolsRequest>(
+            [this, listed, catalog, observe = std::move(observe)](const std::vector<type::Tool>& tools) {
+                toolValidators.add(tools);
+                for (const auto& tool : tools) {
+                    listed->push_back(tool.name);
+                }
+                if (catalog) {
+                    catalog->append(tools);
+                }
+                if (observe) {
+                    observe(tools);
+                }
+            },
+            [this, listed, catalog, version] {
+                toolValidators.retain(*listed);
+                if (catalog) {
+                    cacheTools(catalog, version);
+                }
+            });
+    }
+
+    ListRange<type::ListPromptsRequest> listPrompts() {
+        return list<type::ListPromptsRequest>();
+    }
+
+    ListRange<type::ListResourcesRequest> listResources() {
+        return list<type::ListResourcesRequest>();
+    }
+
+    ListRange<type::ListResourceTemplatesRequest> listResourceTemplates() {
+        return list<type::ListResourceTemplatesRequest>();
+    }
+
+    void stop() { 
+        std::cout << "[MCP] Stopping transport..." << std::endl;
+        transport->stop(); 
+        inbound.reset();  // handles what was already received
+        failAll(RpcError(JsonRpc::ConnectionClosed, "Transport stopped"));
+    }
+
+private:
+    // One message from the server, on the transport's thread or the
+    // inbound queue's
+    void receive(Message&& msg) {
+        if (msg.spilled()) {
+            std::cout << "\n[MCP] <<<< Received spilled message (" << msg.size() << " bytes)" << std::endl;
+        } else {
+            std::cout << "\n[MCP] <<<< Received raw message: " << msg.view() << std::endl;
+        }
+        
+        try {
+            auto j = msg.parse();
+            if (j.contains("method")) {
+                dispatcher.dispatch(j);
+                return;
+            }
+
+            auto res = JsonRpc::parseResponse(j);
+            std::cout << "[MCP] Parsed response:" << std::endl;
+            std::cout << "  - ID: " << res.id << std::endl;
+            if (!res.error.is_null()) {
+                std::cout << "  - Error: " << res.error.dump(2) << std::endl;
+            } else if (msg.spilled()) {
+                std::cout << "  - Result: " << msg.size() << " bytes, not shown" << std::endl;
+            } else {
+                std::cout << "  - Result: " << res.result.dump(2) << std::endl;
+            }
+            complete(std::move(res));
+        } catch (const std::exception& e) {
+            std::cout << "[MCP] Error handling message: " << e.what() << std::endl;
+        }
+    }
+
+    // A request as admission and transmit() take it
+    struct Outgoing {
+        std::string method;
+        nlohmann::json params;
+        std::shared_ptr<const type::CompiledSchema> outputSchema;
+        type::Symbol tool;
+    };
+
+    // tools/call, its arguments checked against the listed inputSchema
+    Outgoing toolCall(type::Symbol name, const nlohmann::json& arguments, const CallOptions& options) {
+        auto schemas = toolValidators.find(name);
+        type::SchemaError error;
+        if (options.validateArguments && schemas.input && !schemas.input->validate(arguments, &error)) {
+            throw RpcError(JsonRpc::InvalidParams, "Invalid arguments for tool " + name.str() + " at \"" + error.path +
+                                                       "\": " + error.message);
+        }
+        return {std::string(type::CallToolRequest::Method), {{"name", name}, {"arguments", arguments}},
+                options.validateOutput ? std::move(schemas.output) : nullptr, name};
+    }
+
+    std::pair<int, std::future<nlohmann::json>> sendToolCall(type::Symbol name, const nlohmann::json& arguments,
+                                                             const CallOptions& options, Deadline deadline) {
+        auto call = toolCall(name, arguments, options);
+        return sendRequest(call.method, call.params, options, deadline, std::move(call.outputSchema), call.tool);
+    }
+
+    nlohmann::json await(int requestId, std::future<nlohmann::json>& future, const std::string& method,
+                         Deadline deadline) {
+        if (future.wait_until(deadline) != std::future_status::ready) {
+            forget(requestId, true);
+            throw RpcError(JsonRpc::RequestTimeout, "Request timed out: " + method);
+        }
+        return future.get();
+    }
+
+    template <class Attempt>
+    nlohmann::json withRetries(const std::string& method, bool idempotent, Deadline deadline, Attempt attempt) {
+        retry.attempted();
+        std::optional<Backoff> backoff;
+        for (int n = 1;; ++n) {
             try {
-                auto res = JsonRpc::parseResponse(msg);
-                std::cout << "[MCP] Parsed response:" << std::endl;
-                std::cout << "  - ID: " << res.id << std::endl;
-                if (!res.error.is_null()) {
-                    std::cout << "  - Error: " << res.error.dump(2) << std::endl;
-                } else {
-                    std::cout << "  - Result: " << res.result.dump(2) << std::endl;
+                return attempt();
+            } catch (const RpcError& e) {
+                if (!retry.enabled()) {
+                    throw;
+                }
+                if (!backoff) {
+                    backoff.emplace(retry.backoff());
                 }
-            } catch (const std::exception& e) {
-                std::cout << "[MCP] Error parsing response: " << e.what() << std::endl;
+                const auto delay = retry.retryAfter(n, e, idempotent, *backoff, deadline);
+                if (!delay) {
+                    throw;
+                }
+                std::cout << "[MCP] " << method << " failed (" << e.what() << "), attempt " << n + 1 << " in "
+                          << delay->count() << "ms" << std::endl;
+                std::this_thread::sleep_for(*delay);
             }
-        });
+        }
+    }
+
+    static RpcError transportFailure(const TransportError& e) {
+        return RpcError(JsonRpc::TransportFailed, e.what(),
+                        {{"status", e.status}, {"delivered", e.delivered}, {"retryAfterMs", e.retryAfter.count()}});
+    }
+
+    // Takes a request out of flight, tells the server with
+    // notifications/cancelled, and fails its future with `error`. See
+    // timedOut() for `expired`.
+    bool withdraw(int requestId, const std::string& reason, const RpcError& error,
+                  ConcurrencyLimiter::Outcome outcome, bool expired = false) {
+        PendingCall entry;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto it = pending.find(requestId);
+            if (it == pending.end()) {
+                return false;
+            }
+            entry = std::move(it->second);
+            pending.erase(it);
+        }
+        release(entry, outcome);
+        if (expired) {
+            timedOut(entry);
+        }
+        nlohmann::json params = {{"requestId", requestId}};
+        if (!reason.empty()) {
+            params["reason"] = reason;
+        }
+        try {
+            transport->send(transcode(JsonRpc::serializeNotification(type::CancelledNotification::Method, params),
+                                      encoding.load()));
+        } catch (const TransportError& e) {
+            std::cout << "[MCP] Cancellation of request " << requestId << " not sent: " << e.what() << std::endl;
+        }
+        entry.promise.set_exception(std::make_exception_ptr(error));
+        settle(entry);
+        return true;
     }
 
-    nlohmann::json call(const std::string& method, const nlohmann::json& params) {
-        JsonRpcRequest req{ "2.0", nextId++, method, params };
-        auto msg = JsonRpc::serializeRequest(req);
+    // Takes a request out of flight and fails its future
+    void fail(int requestId, const RpcError& error) {
+        PendingCall entry;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto it = pending.find(requestId);
+            if (it == pending.end()) {
+                return;
+            }
+            entry = std::move(it->second);
+            pending.erase(it);
+        }
+        release(entry, ConcurrencyLimiter::Outcome::Ignore);
+        entry.promise.set_exception(std::make_exception_ptr(error));
+        settle(entry);
+    }
+
+    Deadline deadlineFor(const CallOptions& options) const {
+        return std::min({options.deadline, currentDeadline(),
+                         std::chrono::steady_clock::now() + std::chrono::milliseconds(config.requestTimeoutMs)});
+    }
+
+    // Fails a call whose remaining budget is below config.minDeadlineBudgetMs
+    void checkBudget(Deadline deadline, const std::string& method) const {
+        const auto left = remainingMs(deadline, std::chrono::steady_clock::now());
+        if (left <= 0 || left < config.minDeadlineBudgetMs) {
+            throw RpcError(JsonRpc::DeadlineExceeded,
+                           "Deadline too close to send " + method + " (" + std::to_string(left) + " ms left)");
+        }
+    }
+
+    template <class Request>
+    ListRange<Request> list(typename ListRange<Request>::Observer observe = {},
+                            typename ListRange<Request>::Completion complete = {}) {
+        auto fetch = [this](const boost::optional<type::Cursor>& cursor) {
+            nlohmann::json params = nlohmann::json::object();
+            if (cursor) {
+                params["cursor"] = *cursor;
+            }
+            return callWithId(std::string(Request::Method), params);
+        };
+        auto drop = [this](int requestId, bool expired) { forget(requestId, expired); };
+        return ListRange<Request>(std::move(fetch), std::move(drop), std::chrono::milliseconds(config.requestTimeoutMs),
+                                  std::move(observe), std::move(complete));
+    }
+
+    static CircuitBreaker::Options breakerOptions(const type::McpServerConfig& cfg) {
+        CircuitBreaker::Options o;
+        o.enabled = cfg.circuitBreaker;
+        o.window = std::chrono::milliseconds(cfg.breakerWindowMs);
+        o.minCalls = static_cast<uint32_t>(std::max(cfg.breakerMinCalls, 1));
+        o.failureRate = cfg.breakerFailureRate;
+        o.slowCall = std::chrono::milliseconds(cfg.breakerSlowCallMs);
+        o.openFor = std::chrono::milliseconds(cfg.breakerOpenMs);
+        o.probeTimeout = std::chrono::milliseconds(cfg.requestTimeoutMs);
+        return o;
+    }
+
+    static RetryPolicy::Options retryOptions(const type::McpServerConfig& cfg) {
+        RetryPolicy::Options o;
+        o.enabled = cfg.retryFailedCalls;
+        o.maxAttempts = cfg.maxCallAttempts;
+        o.baseDelay = std::chrono::milliseconds(cfg.retryBaseDelayMs);
+        o.maxDelay = std::chrono::milliseconds(cfg.retryMaxDelayMs);
+        o.budgetRatio = cfg.retryBudgetRatio;
+        o.budgetReserve = cfg.retryBudgetReserve;
+        return o;
+    }
+
+    static ConcurrencyLimiter::Options limiterOptions(const type::McpServerConfig& cfg) {
+        ConcurrencyLimiter::Options o;
+        o.enabled = cfg.adaptiveConcurrency;
+        o.algorithm = cfg.concurrencyAlgorithm == "aimd"    ? ConcurrencyLimiter::Algorithm::Aimd
+                      : cfg.concurrencyAlgorithm == "fixed" ? ConcurrencyLimiter::Algorithm::Fixed
+                                                            : ConcurrencyLimiter::Algorithm::Gradient;
+        o.initialLimit = cfg.initialConcurrency;
+        o.minLimit = cfg.minConcurrency;
+        o.maxLimit = cfg.maxConcurrency;
+        o.maxQueued = static_cast<size_t>(std::max(cfg.maxQueuedRequests, 0));
+        for (size_t i = 0; i < o.weights.size() && i < cfg.priorityWeights.size(); ++i) {
+            o.weights[i] = static_cast<uint32_t>(std::max(cfg.priorityWeights[i], 1));
+        }
+        return o;
+    }
+
+    void release(PendingCall& entry, ConcurrencyLimiter::Outcome outcome) {
+        if (entry.limited) {
+            entry.limited = false;
+            limiter.release(std::chrono::steady_clock::now() - entry.sentAt, outcome);
+        }
+    }
+
+    // Errors that say the server is unwell, as opposed to a bad request
+    static bool unhealthy(const nlohmann::json& error) {
+        if (error.is_null()) return false;
+        const int code = error.value("code", 0);
+        return code == JsonRpc::InternalError || code == JsonRpc::ServerBusy;
+    }
+
+    std::pair<int, std::future<nlohmann::json>> sendRequest(const std::string& method, const nlohmann::json& params,
+                                                             const CallOptions& options, Deadline deadline,
+                                                             std::shared_ptr<const type::CompiledSchema> outputSchema = nullptr,
+                                                             type::Symbol tool = {}) {
+        const auto wait = admit(method, deadline, tool);
+        if (wait > std::chrono::steady_clock::duration::zero()) {
+            std::this_thread::sleep_for(wait);
+        }
+        if (!limiter.acquire(deadline, options.priority)) {
+            rateLimits.refund(tool);
+            throw shedError(method);
+        }
+        return sendAdmitted(method, params, options, deadline, std::move(outputSchema), tool);
+    }
+
+    // The checks before a request may queue for the concurrency limiter, in
+    // order: the deadline budget, the circuit breaker, the rate limits.
+    // Throws if one refuses. Otherwise the rate limit tokens are taken and
+    // the request must wait the returned time before it goes on.
+    std::chrono::steady_clock::duration admit(const std::string& method, Deadline deadline, type::Symbol tool) {
+        checkBudget(deadline, method);
+        switch (breaker.admit()) {
+            case CircuitBreaker::Admit::Allow:
+                break;
+            case CircuitBreaker::Admit::Probe:
+                sendProbe();
+                [[fallthrough]];
+            case CircuitBreaker::Admit::Reject:
+                throw RpcError(JsonRpc::CircuitOpen, "Circuit open for server " +
+                                                         (config.name.empty() ? id.str() : config.name) + ": " + method);
+        }
+        const auto rateWait = std::min<int64_t>(std::max(config.rateLimitWaitMs, 0),
+                                                remainingMs(deadline, std::chrono::steady_clock::now()));
+        const auto wait = rateLimits.reserve(tool, std::chrono::milliseconds(rateWait));
+        if (!wait) {
+            throw RpcError(JsonRpc::RateLimited, "Rate limit reached for " +
+                                                     (tool.empty() ? "server " + (config.name.empty() ? id.str() : config.name)
+                                                                   : "tool " + tool.str()) + ": " + method);
+        }
+        return *wait;
+    }
+
+    static RpcError shedError(const std::string& method) {
+        return RpcError(JsonRpc::Overloaded, "Request shed by the concurrency limiter: " + method);
+    }
+
+    // transmit() for a request that holds its limiter slot. Its rate limit
+    // tokens are refunded if it never reached the server.
+    std::pair<int, std::future<nlohmann::json>> sendAdmitted(const std::string& method, const nlohmann::json& params,
+                                                              const CallOptions& options, Deadline deadline,
+                                                              std::shared_ptr<const type::CompiledSchema> outputSchema,
+                                                              type::Symbol tool) {
+        try {
+            return transmit(method, params, options, deadline, std::move(outputSchema));
+        } catch (const RpcError& e) {
+            // Never reached the server: its rate limit tokens are unused
+            if (e.code == JsonRpc::DeadlineExceeded ||
+                (e.code == JsonRpc::TransportFailed && !e.data.value("delivered", true))) {
+                rateLimits.refund(tool);
+            }
+            throw;
+        }
+    }
+
+    // Half-open probe; its answer is routed to the breaker by complete().
+    // A probe that cannot be sent fails at once, reopening the circuit
+    // instead of leaving it half-open until probeTimeout; the caller still
+    // sees CircuitOpen.
+    void sendProbe() {
+        if (const int previous = probeId.exchange(0)) {
+            forget(previous);
+        }
+        try {
+            auto probe = transmit(std::string(type::PingRequest::Method), nlohmann::json::object(), CallOptions{},
+                                  NoDeadline, nullptr, true);
+            probeId = probe.first;
+        } catch (const std::exception& e) {
+            std::cout << "[MCP] Circuit probe could not be sent: " << e.what() << std::endl;
+            breaker.probeResult(false);
+        }
+    }
+
+    std::pair<int, std::future<nlohmann::json>> transmit(const std::string& method, const nlohmann::json& params,
+                                                         const CallOptions& options, Deadline deadline,
+                                                         std::shared_ptr<const type::CompiledSchema> outputSchema,
+                                                         bool probe = false) {
+        const int requestId = nextId++;
+        PendingCall entry;
+        entry.outputSchema = std::move(outputSchema);
+        entry.sentAt = std::chrono::steady_clock::now();
+        entry.probe = probe;
+        entry.callerDeadline = !probe && std::min(options.deadline, currentDeadline()) <= deadline;
+        entry.limited = !probe && limiter.enabled();
+        entry.settled = options.onSettled;
+        entry.priority = options.priority;
+        auto future = entry.promise.get_future();
+
+        // The request id doubles as the progress token
+        const bool sendDeadline = config.propagateDeadlines && !probe;
+        nlohmann::json withMeta;
+        if (options.onProgress || sendDeadline) {
+            withMeta = params.is_object() ? params : nlohmann::json::object();
+        }
+        if (options.onProgress) {
+            withMeta["_meta"]["progressToken"] = requestId;
+            entry.progress = std::make_shared<ProgressThrottle>(options.onProgress, options.progressInterval);
+        }
+        const auto& sentParams = options.onProgress || sendDeadline ? withMeta : params;
+
+        const auto wire = encoding.load();
+        std::string msg;
+        try {
+            // The budget may have run down while the request was queued
+            if (!probe) {
+                checkBudget(deadline, method);
+            }
+            // What is left of the deadline, less the time for the answer to
+            // come back (see deadline.hpp)
+            if (sendDeadline) {
+                const auto budget = remainingMs(deadline, std::chrono::steady_clock::now()) - config.deadlineMarginMs;
+                withMeta["_meta"][std::string(DeadlineMetaKey)] = std::max<int64_t>(budget, 0);
+            }
+            msg = wire == WireEncoding::Json
+                      ? JsonRpc::serializeRequest(requestId, method, sentParams)
+                      : encode({{"jsonrpc", "2.0"}, {"id", requestId}, {"method", method}, {"params", sentParams}}, wire);
+        } catch (...) {
+            release(entry, ConcurrencyLimiter::Outcome::Ignore);
+            throw;
+        }
+        if (config.autoReconnect) {
+            entry.wire = msg;
+            entry.wireEncoding = wire;
+            entry.stamped = sendDeadline;
+            entry.deadline = probe ? NoDeadline : deadline;
+        }
+
+        // While reconnecting, the request waits for the new session and is
+        // sent with the other in-flight ones (see statusChanged)
+        bool held = false;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            held = config.autoReconnect && status.load() == type::ConnectionStatus::RECONNECTING;
+            entry.held = held;
+            pending.emplace(requestId, std::move(entry));
+        }
         
-        std::cout << "[MCP] >>>> Sending request (id=" << req.id << "):" << std::endl;
+        std::cout << "[MCP] >>>> Sending request (id=" << requestId << "):" << std::endl;
         std::cout << "  - Method: " << method << std::endl;
-        std::cout << "  - Params: " << params.dump(2) << std::endl;
-        std::cout << "  - Raw JSON: " << msg << std::endl;
+        std::cout << "  - Params: " << sentParams.dump(2) << std::endl;
+        if (wire == WireEncoding::Json) {
+            std::cout << "  - Raw JSON: " << msg << std::endl;
+        } else {
+            std::cout << "  - Encoded (" << encodingName(wire) << "): " << msg.size() << " bytes" << std::endl;
+        }
         
-        transport->send(msg);
-        return {};
+        if (held) {
+            std::cout << "[MCP] Reconnecting, request " << requestId << " held until the session is back" << std::endl;
+        } else {
+            try {
+                transport->send(msg);
+                if (config.autoReconnect) {
+                    markSent(requestId);
+                }
+            } catch (const TransportError& e) {
+                // Never in flight: the caller gets the error instead of a future
+                PendingCall failed;
+                {
+                    std::lock_guard<std::mutex> lock(pendingMutex);
+                    auto it = pending.find(requestId);
+                    if (it == pending.end()) {
+                        return {requestId, std::move(future)};  // answered regardless
+                    }
+                    failed = std::move(it->second);
+                    pending.erase(it);
+                }
+                const bool busy = e.status == 429 || e.status == 503;
+                release(failed, busy ? ConcurrencyLimiter::Outcome::Overload : ConcurrencyLimiter::Outcome::Ignore);
+                if (e.status == 0 || e.status >= 500) {
+                    breaker.record(false, std::chrono::steady_clock::now() - failed.sentAt);
+                }
+                throw transportFailure(e);
+            }
+        }
+        return {requestId, std::move(future)};
     }
 
-    void stop() { 
-        std::cout << "[MCP] Stopping transport..." << std::endl;
-        transport->stop(); 
+    void complete(JsonRpcResponse res) {
+        PendingCall entry;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto it = pending.find(res.id);
+            if (it == pending.end()) {
+                std::cout << "[MCP] No pending request for response id " << res.id << std::endl;
+                return;
+            }
+            entry = std::move(it->second);
+            pending.erase(it);
+        }
+
+        if (entry.progress) {
+            entry.progress->flush();
+        }
+        const bool busy = !res.error.is_null() && res.error.value("code", 0) == JsonRpc::ServerBusy;
+        release(entry, busy ? ConcurrencyLimiter::Outcome::Overload : ConcurrencyLimiter::Outcome::Success);
+        if (entry.probe) {
+            breaker.probeResult(!unhealthy(res.error));
+        } else {
+            breaker.record(!unhealthy(res.error), std::chrono::steady_clock::now() - entry.sentAt);
+        }
+        if (!res.error.is_null()) {
+            entry.promise.set_exception(std::make_exception_ptr(RpcError::fromJson(res.error)));
+        } else if (entry.outputSchema && !checkOutput(*entry.outputSchema, res.result)) {
+            type::SchemaError error;
+            const auto it = res.result.find("structuredContent");
+            if (it != res.result.end()) {
+                entry.outputSchema->validate(*it, &error);
+            } else {
+                error.message = "missing structuredContent";
+            }
+            entry.promise.set_exception(std::make_exception_ptr(RpcError(
+                JsonRpc::InvalidOutput, "Invalid structuredContent at \"" + error.path + "\": " + error.message)));
+        } else {
+            entry.promise.set_value(std::move(res.result));
+        }
+        settle(entry);
+    }
+
+    static void settle(PendingCall& entry) {
+        if (entry.settled) {
+            entry.settled();
+        }
+    }
+
+    // Error results (isError: true) carry no structured output to check
+    static bool checkOutput(const type::CompiledSchema& schema, const nlohmann::json& result) {
+        if (!result.is_object()) return false;
+        const auto isError = result.find("isError");
+        if (isError != result.end() && isError->is_boolean() && isError->get<bool>()) return true;
+        const auto it = result.find("structuredContent");
+        return it != result.end() && schema.validate(*it);
+    }
+
+    struct Resend {
+        Priority priority;
+        int id;
+        std::string wire;
+        WireEncoding wireEncoding;
+        bool stamped;
+        Deadline deadline;
+    };
+
+    // A request being sent again after a reconnect. Its deadline has kept
+    // running: an expired call fails with DeadlineExceeded instead, and the
+    // budget in _meta is re-stamped with what is left now.
+    std::string restamped(const Resend& r) const {
+        checkBudget(r.deadline, "request " + std::to_string(r.id));
+        if (!r.stamped) {
+            return r.wire;
+        }
+        auto msg = decode(r.wire, r.wireEncoding);
+        const auto budget = remainingMs(r.deadline, std::chrono::steady_clock::now()) - config.deadlineMarginMs;
+        msg["params"]["_meta"][std::string(DeadlineMetaKey)] = std::max<int64_t>(budget, 0);
+        return r.wireEncoding == WireEncoding::Json ? msg.dump() : encode(msg, r.wireEncoding);
+    }
+
+    void markSent(int requestId) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto it = pending.find(requestId);
+        if (it != pending.end()) {
+            it->second.sent = true;
+        }
+    }
+
+    // With autoReconnect, requests in flight when the stream drops are kept.
+    // Once the stream is back, requests held while reconnecting are sent,
+    // and those already sent are re-sent unless the server resumed the
+    // session (and so replays their responses). A request whose send() was
+    // still under way is left to its caller. Without autoReconnect, and
+    // when the transport gives up, callers are failed at once instead of
+    // waiting out requestTimeoutMs.
+    void statusChanged(type::ConnectionStatus s) {
+        std::vector<Resend> resend;
+        type::ConnectionStatus previous;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            previous = status.exchange(s);
+            if (s == type::ConnectionStatus::CONNECTED && previous == type::ConnectionStatus::RECONNECTING) {
+                const bool resumed = transport->resumedSession();
+                resend.reserve(pending.size());
+                for (auto& [requestId, entry] : pending) {
+                    if (entry.held || (entry.sent && !resumed)) {
+                        entry.held = false;
+                        entry.sent = false;
+                        resend.push_back(
+                            {entry.priority, requestId, entry.wire, entry.wireEncoding, entry.stamped, entry.deadline});
+                    }
+                }
+            }
+        }
+        // Highest priority first, original order within a priority
+        std::sort(resend.begin(), resend.end(), [](const Resend& a, const Resend& b) {
+            return a.priority != b.priority ? a.priority > b.priority : a.id < b.id;
+        });
+        switch (s) {
+            case type::ConnectionStatus::CONNECTED:
+                lastConnected = std::chrono::steady_clock::now();
+                retryCount = 0;
+                breaker.allowProbe();
+                if (!resend.empty()) {
+                    std::cout << "[MCP] Session re-established, sending " << resend.size() << " request(s)" << std::endl;
+                }
+                for (const auto& r : resend) {
+                    try {
+                        transport->send(r.deadline == NoDeadline ? r.wire : restamped(r));
+                        markSent(r.id);
+                    } catch (const TransportError& e) {
+                        fail(r.id, transportFailure(e));
+                    } catch (const RpcError& e) {
+                        fail(r.id, e);
+                    }
+                }
+                break;
+            case type::ConnectionStatus::RECONNECTING:
+                ++retryCount;
+                if (!config.autoReconnect) {
+                    failAll(RpcError(JsonRpc::ConnectionClosed, "Connection lost"));
+                }
+                break;
+            case type::ConnectionStatus::ERROR:
+                breaker.trip();
+                failAll(RpcError(JsonRpc::ConnectionClosed, "Connection lost"));
+                break;
+            case type::ConnectionStatus::DISCONNECTED:
+                failAll(RpcError(JsonRpc::ConnectionClosed, "Transport stopped"));
+                break;
+            default:
+                break;
+        }
+        if (statusCallback) {
+            statusCallback(id, s);
+        }
+    }
+
+    // A call whose deadline passed unanswered counts against the server,
+    // with the time it was actually in flight, only if requestTimeoutMs
+    // ran out. A caller's shorter deadline says nothing about its health.
+    void timedOut(const PendingCall& entry) {
+        if (!entry.callerDeadline) {
+            breaker.record(false, std::chrono::steady_clock::now() - entry.sentAt);
+        }
+    }
+
+    // Drops a request that timed out (`expired`, see timedOut()) or was
+    // abandoned; for the limiter that is overload
+    void forget(int requestId, bool expired = false) {
+        PendingCall entry;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto it = pending.find(requestId);
+            if (it == pending.end()) {
+                return;
+            }
+            entry = std::move(it->second);
+            pending.erase(it);
+        }
+        release(entry, ConcurrencyLimiter::Outcome::Overload);
+        if (expired) {
+            timedOut(entry);
+        }
+    }
+
+    void failAll(const RpcError& error) {
+        std::unordered_map<int, PendingCall> failed;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            failed.swap(pending);
+        }
+        for (auto& [requestId, entry] : failed) {
+            release(entry, ConcurrencyLimiter::Outcome::Ignore);
+            entry.promise.set_exception(std::make_exception_ptr(error));
+            settle(entry);
+        }
+    }
+
+    void toolListChanged() {
+        toolValidators.clear();
+        std::lock_guard<std::mutex> lock(toolCacheMutex);
+        toolCache.reset();
+        ++toolListVersion;
+    }
+
+    uint64_t toolListSeen() const {
+        std::lock_guard<std::mutex> lock(toolCacheMutex);
+        return toolListVersion;
+    }
+
+    // Publishes a complete listing begun at `version`, unless the list
+    // changed since
+    void cacheTools(std::shared_ptr<type::ToolCatalog> catalog, uint64_t version) {
+        catalog->finish();
+        std::lock_guard<std::mutex> lock(toolCacheMutex);
+        if (version == toolListVersion) {
+            toolCache = std::move(catalog);
+        }
+    }
+
+    void routeProgress(const type::ProgressNotification::Params& params) {
+        const auto* token = std::get_if<int64_t>(&params.progressToken);
+        if (!token) {
+            return;
+        }
+        std::shared_ptr<ProgressThrottle> progress;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto it = pending.find(static_cast<int>(*token));
+            if (it != pending.end()) {
+                progress = it->second.progress;
+            }
+        }
+        if (progress) {
+            progress->update(params);
+        }
     }
 };
 
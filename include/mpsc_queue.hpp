@@ -0,0 +1,220 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mcp {
+
+// ============================================================================
+// MpscQueue
+// ============================================================================
+//
+// Bounded lock-free queue for many producers and one consumer, after
+// Vyukov's array queue: every cell carries a sequence number saying whose
+// turn it is, so a push is one CAS on the tail and a pop touches no shared
+// counter. Values are moved in and out, never copied. The capacity is
+// rounded up to a power of two.
+//
+// Locks are only taken to sleep: the consumer parks when the queue is
+// empty and a producer takes the mutex only to wake it; push() parks a
+// producer while the queue is full, tryPush() fails instead.
+
+template <class T>
+class MpscQueue {
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> tail{0};  // next push, shared by producers
+    alignas(64) size_t head = 0;              // next pop, consumer only
+
+    std::atomic<bool> parked{false};  // the consumer is, or is about to be, asleep
+    std::atomic<bool> closed{false};
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::atomic<int> blocked{0};  // producers waiting in push()
+
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    bool ready() const {
+        return cells[head & mask].sequence.load(std::memory_order_acquire) == head + 1;
+    }
+
+    void wakeConsumer() {
+        // Pairs with the fence in wait(): either the consumer sees the new
+        // value before sleeping, or this sees it parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) && parked.exchange(false)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            notEmpty.notify_one();
+        }
+    }
+
+public:
+    explicit MpscQueue(size_t capacity) : cells(new Cell[roundUp(capacity)]), mask(roundUp(capacity) - 1) {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Moves `value` in unless the queue is full or closed; on failure
+    // `value` is left untouched
+    bool tryPush(T&& value) {
+        if (closed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    wakeConsumer();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Waits while the queue is full. Returns false if it was closed.
+    bool push(T&& value) {
+        while (!tryPush(std::move(value))) {
+            if (closed.load()) {
+                return false;
+            }
+            ++blocked;
+            {
+                // Timed: a drain between the failed push and this wait
+                // would otherwise go unnoticed
+                std::unique_lock<std::mutex> lock(mutex);
+                notFull.wait_for(lock, std::chrono::milliseconds(1));
+            }
+            --blocked;
+        }
+        return true;
+    }
+
+    // Consumer: moves up to `max` values out, oldest first, into
+    // consume(T&&). Returns how many.
+    template <class Consume>
+    size_t drain(Consume&& consume, size_t max) {
+        size_t n = 0;
+        while (n < max && ready()) {
+            Cell& cell = cells[head & mask];
+            T value = std::move(cell.value);
+            cell.value = T();
+            cell.sequence.store(head + mask + 1, std::memory_order_release);
+            ++head;
+            ++n;
+            consume(std::move(value));
+        }
+        if (n > 0 && blocked.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            notFull.notify_all();
+        }
+        return n;
+    }
+
+    // Consumer: sleeps until there is something to drain. Returns false
+    // once the queue is closed and empty.
+    bool wait() {
+        while (!ready()) {
+            if (closed.load()) {
+                return false;
+            }
+            parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready() || closed.load()) {
+                parked.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return !parked.load() || closed.load(); });
+        }
+        return true;
+    }
+
+    // Refuses further pushes; the consumer still drains what is queued
+    void close() {
+        closed.store(true);
+        std::lock_guard<std::mutex> lock(mutex);
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    // Approximate while producers are active
+    size_t size() const {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        return t > head ? t - head : 0;
+    }
+};
+
+// ============================================================================
+// DrainThread
+// ============================================================================
+//
+// Owns an MpscQueue and the thread that consumes it, up to `batch` values
+// per wakeup. Destruction closes the queue, lets the thread finish what was
+// queued, and joins it.
+
+template <class T>
+class DrainThread {
+public:
+    using Consume = std::function<void(T&&)>;
+
+private:
+    MpscQueue<T> queue;
+    Consume consume;
+    const size_t batch;
+    std::thread thread;
+
+public:
+    DrainThread(size_t capacity, size_t batch, Consume fn)
+        : queue(capacity), consume(std::move(fn)), batch(batch > 0 ? batch : 1) {
+        thread = std::thread([this] {
+            while (queue.wait()) {
+                queue.drain(consume, this->batch);
+            }
+        });
+    }
+
+    ~DrainThread() {
+        queue.close();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    DrainThread(const DrainThread&) = delete;
+    DrainThread& operator=(const DrainThread&) = delete;
+
+    MpscQueue<T>& input() { return queue; }
+};
+
+} // namespace mcp
@@ -0,0 +1,201 @@
+#pragma once
+#include "type/schema.hpp"
+#include "type/schema_serialization.hpp"
+#include "jsonrpc.hpp"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace mcp {
+
+// ============================================================================
+// Cursor-based list operations
+// ============================================================================
+
+template <class Request> struct ListTraits;
+
+template <> struct ListTraits<type::ListToolsRequest> {
+    using Result = type::ListToolsResult;
+    using Item = type::Tool;
+    static constexpr auto items = &Result::tools;
+};
+
+template <> struct ListTraits<type::ListPromptsRequest> {
+    using Result = type::ListPromptsResult;
+    using Item = type::Prompt;
+    static constexpr auto items = &Result::prompts;
+};
+
+template <> struct ListTraits<type::ListResourcesRequest> {
+    using Result = type::ListResourcesResult;
+    using Item = type::Resource;
+    static constexpr auto items = &Result::resources;
+};
+
+template <> struct ListTraits<type::ListResourceTemplatesRequest> {
+    using Result = type::ListResourceTemplatesResult;
+    using Item = type::ResourceTemplate;
+    static constexpr auto items = &Result::resourceTemplates;
+};
+
+// ============================================================================
+// ListRange
+// ============================================================================
+//
+// Lazy input range over every item of a paginated list. A page is requested
+// only when iteration reaches it, and the request for the following page is
+// sent as soon as a page arrives so it downloads while the current one is
+// consumed. At most two pages are held at once. Breaking out of the loop
+// stops the paging; a prefetch still in flight is withdrawn when the range
+// is destroyed.
+//
+//     for (const auto& tool : client.listTools()) { ... }
+
+template <class Request>
+class ListRange {
+public:
+    using Traits = ListTraits<Request>;
+    using Item = typename Traits::Item;
+    // Sends the request for a page, returning its id and future
+    using Fetch = std::function<std::pair<int, std::future<nlohmann::json>>(const boost::optional<type::Cursor>&)>;
+    // Drops a page request that timed out (`expired`) or was abandoned
+    using Withdraw = std::function<void(int requestId, bool expired)>;
+    // Sees every page as it arrives, e.g. to index or cache the items
+    using Observer = std::function<void(const std::vector<Item>&)>;
+    // Runs once the last page has been observed, i.e. the whole list was seen
+    using Completion = std::function<void()>;
+
+private:
+    Fetch fetch;
+    Withdraw withdraw;
+    Observer observe;
+    Completion complete;
+    std::chrono::milliseconds timeout;
+    int nextId = 0;
+    std::future<nlohmann::json> next;
+    std::vector<Item> page;
+    size_t index = 0;
+    bool started = false;
+
+    // Waits for the prefetched page, then prefetches the one after it.
+    // Skips empty pages; returns false once the list is exhausted.
+    bool loadNext() {
+        while (next.valid()) {
+            if (next.wait_for(timeout) != std::future_status::ready) {
+                withdraw(nextId, true);
+                next = {};
+                throw RpcError(JsonRpc::RequestTimeout, std::string("Request timed out: ") + std::string(Request::Method));
+            }
+            auto result = next.get().template get<typename Traits::Result>();
+            if (result.nextCursor && !result.nextCursor->empty()) {
+                std::tie(nextId, next) = fetch(result.nextCursor);
+            }
+            if (observe) {
+                observe(result.*Traits::items);
+            }
+            if (!next.valid() && complete) {
+                complete();
+            }
+            page = std::move(result.*Traits::items);
+            index = 0;
+            if (!page.empty()) {
+                return true;
+            }
+        }
+        page.clear();
+        return false;
+    }
+
+    // Breaking out of the loop leaves the prefetched page unawaited
+    void abandon() {
+        if (next.valid()) {
+            withdraw(nextId, false);
+            next = {};
+        }
+    }
+
+    bool advance() {
+        if (++index < page.size()) {
+            return true;
+        }
+        return loadNext();
+    }
+
+public:
+    class iterator {
+        ListRange* range = nullptr;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Item*;
+        using reference = const Item&;
+
+        iterator() = default;
+        explicit iterator(ListRange* r) : range(r) {}
+
+        reference operator*() const { return range->page[range->index]; }
+        pointer operator->() const { return &range->page[range->index]; }
+
+        iterator& operator++() {
+            if (!range->advance()) {
+                range = nullptr;
+            }
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(const iterator& other) const { return range == other.range; }
+        bool operator!=(const iterator& other) const { return range != other.range; }
+    };
+
+    ListRange(Fetch fetch, Withdraw withdraw, std::chrono::milliseconds timeout, Observer observe = {},
+              Completion complete = {})
+        : fetch(std::move(fetch)), withdraw(std::move(withdraw)), observe(std::move(observe)),
+          complete(std::move(complete)), timeout(timeout) {}
+
+    ~ListRange() { abandon(); }
+
+    ListRange(ListRange&&) = default;
+
+    ListRange& operator=(ListRange&& other) {
+        if (this != &other) {
+            abandon();
+            fetch = std::move(other.fetch);
+            withdraw = std::move(other.withdraw);
+            observe = std::move(other.observe);
+            complete = std::move(other.complete);
+            timeout = other.timeout;
+            nextId = other.nextId;
+            next = std::move(other.next);
+            page = std::move(other.page);
+            index = other.index;
+            started = other.started;
+        }
+        return *this;
+    }
+
+    // Single pass: begin() sends the first request, later calls resume
+    iterator begin() {
+        if (!started) {
+            started = true;
+            std::tie(nextId, next) = fetch(boost::none);
+            if (!loadNext()) {
+                return end();
+            }
+        }
+        return index < page.size() ? iterator(this) : end();
+    }
+
+    iterator end() {
+        return iterator();
+    }
+};
+
+} // namespace mcp
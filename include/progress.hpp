@@ -0,0 +1,116 @@
+#pragma once
+#include "type/schema.hpp"
+#include "executor.hpp"
+#include "timer_queue.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace mcp {
+
+using ProgressCallback = std::function<void(const type::ProgressNotification::Params&)>;
+
+// ============================================================================
+// ProgressThrottle
+// ============================================================================
+//
+// Coalesces notifications/progress for one call. Every update overwrites the
+// latest value; the callback runs at most once per `minInterval` and always
+// sees the newest value. A value held back is delivered once the interval
+// has passed (on the shared Executor, from a TimerQueue timer) even if no
+// further update arrives, so bursty progress does not freeze. flush()
+// waits out a delivery already running on another thread and then delivers
+// the newest value at once; it is called when the call completes so the
+// consumer sees the final progress before the result. Create with
+// std::make_shared.
+
+class ProgressThrottle : public std::enable_shared_from_this<ProgressThrottle> {
+    ProgressCallback callback;
+    std::chrono::steady_clock::duration minInterval;
+
+    std::mutex mutex;
+    std::condition_variable idle;  // signalled when a delivery finishes
+    type::ProgressNotification::Params latest;
+    bool dirty = false;
+    bool delivering = false;
+    bool scheduled = false;  // a trailing delivery is pending
+    std::chrono::steady_clock::time_point lastDelivery{};
+
+    // Delivers without holding the lock; one delivery at a time so the
+    // consumer never sees values out of order. A value that arrives during
+    // the callback is delivered straight away only if the interval has
+    // already passed (slow callback); otherwise it becomes a trailing
+    // delivery. `force` (flush) ignores the interval.
+    void deliver(std::unique_lock<std::mutex>& lock, bool force = false) {
+        delivering = true;
+        while (dirty) {
+            auto value = latest;
+            dirty = false;
+            lastDelivery = std::chrono::steady_clock::now();
+            lock.unlock();
+            try {
+                callback(value);
+            } catch (...) {
+            }
+            lock.lock();
+            if (dirty && !force && std::chrono::steady_clock::now() - lastDelivery < minInterval) {
+                if (!scheduled) {
+                    scheduled = true;
+                    scheduleTrailing(lastDelivery + minInterval);
+                }
+                break;
+            }
+        }
+        delivering = false;
+        idle.notify_all();
+    }
+
+    void scheduleTrailing(std::chrono::steady_clock::time_point when) {
+        std::weak_ptr<ProgressThrottle> weak = weak_from_this();
+        TimerQueue::shared().at(when, [weak] {
+            auto trailing = [weak] {
+                if (auto self = weak.lock()) {
+                    std::unique_lock<std::mutex> lock(self->mutex);
+                    self->scheduled = false;
+                    if (!self->delivering) {
+                        self->deliver(lock);
+                    }
+                }
+            };
+            if (!Executor::shared()->trySubmit(trailing)) {
+                trailing();
+            }
+        });
+    }
+
+public:
+    ProgressThrottle(ProgressCallback cb, std::chrono::milliseconds interval)
+        : callback(std::move(cb)), minInterval(interval) {}
+
+    void update(type::ProgressNotification::Params params) {
+        std::unique_lock<std::mutex> lock(mutex);
+        latest = std::move(params);
+        dirty = true;
+        if (delivering) {
+            return;
+        }
+        if (std::chrono::steady_clock::now() - lastDelivery < minInterval) {
+            if (!scheduled) {
+                scheduled = true;
+                scheduleTrailing(lastDelivery + minInterval);
+            }
+            return;
+        }
+        deliver(lock);
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return !delivering; });
+        deliver(lock, true);
+    }
+};
+
+} // namespace mcp
@@ -0,0 +1,178 @@
+#pragma once
+#include "type/symbol.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace mcp {
+
+// ============================================================================
+// TokenBucket
+// ============================================================================
+//
+// `perSecond` requests per second with bursts of up to `burst`, as a
+// generic cell rate algorithm: the bucket is a single atomic timestamp, the
+// theoretical arrival time (TAT) of the next request if the bucket were
+// drained at the steady rate. Taking a token advances the TAT by one
+// interval with a compare-and-swap; the request is within its limit while
+// the TAT stays no more than `burst` intervals ahead of now. A request
+// that is over the limit can instead book the next free token and wait
+// until it is due, so waiting callers are served in arrival order without
+// a queue or a lock.
+
+class TokenBucket {
+    using Clock = std::chrono::steady_clock;
+
+    int64_t interval;   // ns per token
+    int64_t tolerance;  // burst * interval
+    std::atomic<int64_t> tat{0};
+    std::atomic<uint64_t> limited{0};
+
+    static int64_t nanos(Clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+public:
+    TokenBucket(double perSecond, double burst)
+        : interval(static_cast<int64_t>(1e9 / std::max(perSecond, 1e-9))),
+          tolerance(static_cast<int64_t>(std::max(burst, 1.0) * static_cast<double>(interval))) {}
+
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    // Takes a token, booking the next one if it frees up within `maxWait`.
+    // Returns how long to wait before sending (zero: at once), or nullopt
+    // if the request is over the limit.
+    std::optional<Clock::duration> reserve(Clock::time_point now, Clock::duration maxWait) {
+        const int64_t t = nanos(now);
+        const int64_t patience = std::chrono::duration_cast<std::chrono::nanoseconds>(maxWait).count();
+        int64_t current = tat.load(std::memory_order_relaxed);
+        for (;;) {
+            const int64_t next = std::max(current, t) + interval;
+            const int64_t wait = next - t - tolerance;
+            if (wait > patience) {
+                limited.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            if (tat.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+                return std::chrono::nanoseconds(std::max<int64_t>(wait, 0));
+            }
+        }
+    }
+
+    // Gives back a token taken by reserve() for a request that was not sent
+    void refund() {
+        tat.fetch_sub(interval, std::memory_order_relaxed);
+    }
+
+    // Requests refused so far
+    uint64_t rejected() const {
+        return limited.load(std::memory_order_relaxed);
+    }
+};
+
+// ============================================================================
+// RateLimits
+// ============================================================================
+//
+// One server's token buckets: one for all its requests, and one per tool
+// name for tools/call. Built once from the server's config; admit() only
+// reads the tool map, so the check is a hash lookup plus one CAS per bucket.
+
+class RateLimits {
+    using Clock = std::chrono::steady_clock;
+
+    std::optional<TokenBucket> server;
+    std::unordered_map<type::Symbol, TokenBucket> tools;
+
+public:
+    RateLimits() = default;
+
+    // perSecond <= 0 leaves the server unlimited
+    void limitServer(double perSecond, double burst) {
+        if (perSecond > 0) {
+            server.emplace(perSecond, burst);
+        }
+    }
+
+    void limitTool(type::Symbol tool, double perSecond, double burst) {
+        if (perSecond > 0) {
+            tools.erase(tool);
+            tools.try_emplace(tool, perSecond, burst);
+        }
+    }
+
+    bool empty() const { return !server && tools.empty(); }
+
+    // Takes a token from the server's bucket and, for a tool call, the
+    // tool's, sleeping until both are due if that is within `maxWait`.
+    // Returns false, with nothing taken, if either is over its limit.
+    bool admit(type::Symbol tool, Clock::duration maxWait) {
+        const auto wait = reserve(tool, maxWait);
+        if (!wait) {
+            return false;
+        }
+        if (*wait > Clock::duration::zero()) {
+            std::this_thread::sleep_for(*wait);
+        }
+        return true;
+    }
+
+    // admit() without the sleep, for callers that wait on a timer instead:
+    // how long until both tokens are due, or nullopt with nothing taken
+    std::optional<Clock::duration> reserve(type::Symbol tool, Clock::duration maxWait) {
+        if (empty()) {
+            return Clock::duration::zero();
+        }
+        const auto now = Clock::now();
+        Clock::duration wait{0};
+        TokenBucket* toolBucket = nullptr;
+        if (!tool.empty()) {
+            auto it = tools.find(tool);
+            if (it != tools.end()) {
+                toolBucket = &it->second;
+                auto w = toolBucket->reserve(now, maxWait);
+                if (!w) {
+                    return std::nullopt;
+                }
+                wait = *w;
+            }
+        }
+        if (server) {
+            auto w = server->reserve(now, maxWait);
+            if (!w) {
+                if (toolBucket) toolBucket->refund();
+                return std::nullopt;
+            }
+            wait = std::max(wait, *w);
+        }
+        return wait;
+    }
+
+    // Gives back the tokens admit() or reserve() took for a request that was never sent
+    void refund(type::Symbol tool) {
+        if (!tool.empty()) {
+            auto it = tools.find(tool);
+            if (it != tools.end()) {
+                it->second.refund();
+            }
+        }
+        if (server) {
+            server->refund();
+        }
+    }
+
+    uint64_t rejected() const {
+        uint64_t n = server ? server->rejected() : 0;
+        for (const auto& [name, bucket] : tools) {
+            n += bucket.rejected();
+        }
+        return n;
+    }
+};
+
+} // namespace mcp
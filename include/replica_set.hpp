@@ -0,0 +1,440 @@
+#pragma once
+#include "mcp.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace mcp {
+
+// ============================================================================
+// LatencyTracker
+// ============================================================================
+//
+// Approximate latency quantiles over recent calls: a log-scale histogram
+// with four buckets per power of two (about 19% wide) from 1 us to ~70 min.
+// Counts are halved every `decayAfter` samples so the estimate follows the
+// server as it speeds up or slows down.
+
+class LatencyTracker {
+    static constexpr size_t BucketsPerOctave = 4;
+    static constexpr size_t Buckets = 32 * BucketsPerOctave;
+
+    std::mutex mutex;
+    std::array<uint32_t, Buckets> counts{};
+    uint32_t total = 0;
+    uint32_t decayAfter;
+
+    static size_t bucketOf(std::chrono::microseconds latency) {
+        const double us = std::max<double>(static_cast<double>(latency.count()), 1.0);
+        const auto b = static_cast<size_t>(std::log2(us) * BucketsPerOctave);
+        return std::min(b, Buckets - 1);
+    }
+
+    // Upper edge of a bucket
+    static std::chrono::microseconds edgeOf(size_t bucket) {
+        return std::chrono::microseconds(
+            static_cast<int64_t>(std::ceil(std::exp2(static_cast<double>(bucket + 1) / BucketsPerOctave))));
+    }
+
+public:
+    explicit LatencyTracker(uint32_t decayAfter = 4096) : decayAfter(std::max<uint32_t>(decayAfter, 2)) {}
+
+    void record(std::chrono::steady_clock::duration latency) {
+        const size_t b = bucketOf(std::chrono::duration_cast<std::chrono::microseconds>(latency));
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counts[b];
+        if (++total >= decayAfter) {
+            total = 0;
+            for (auto& c : counts) {
+                c /= 2;
+                total += c;
+            }
+        }
+    }
+
+    uint32_t samples() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return total;
+    }
+
+    // Latency below which `q` of recent calls completed; zero without samples
+    std::chrono::microseconds quantile(double q) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (total == 0) {
+            return std::chrono::microseconds(0);
+        }
+        const auto rank = static_cast<uint32_t>(std::ceil(q * total));
+        uint32_t seen = 0;
+        for (size_t b = 0; b < Buckets; ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                return edgeOf(b);
+            }
+        }
+        return edgeOf(Buckets - 1);
+    }
+};
+
+// ============================================================================
+// ReplicaSet
+// ============================================================================
+//
+// One logical server backed by several replicas, each an mcp client with
+// its own transport, circuit breaker and pending calls. Calls go to the
+// replica with the fewest outstanding requests (or the better of two
+// random picks), skipping replicas whose circuit is open.
+//
+// With hedging on, call()/callTool() for read-only or idempotent tools
+// (per the ToolAnnotations seen by listTools()) send a second copy to
+// another replica when the first has not answered within the recent p95
+// latency. The first successful answer wins and the other copy is
+// cancelled with notifications/cancelled. At most one extra request is
+// sent, and only for calls slower than the p95.
+//
+//     ReplicaSet search(std::move(transports), config);
+//     search.start();
+//     search.broadcast("initialize", initParams);
+//     for (const auto& tool : search.listTools()) { ... }
+//     auto result = search.callTool("lookup", args);
+
+class ReplicaSet {
+public:
+    enum class Balance : uint8_t { LeastOutstanding, PowerOfTwoChoices };
+
+    struct Options {
+        Balance balance = Balance::LeastOutstanding;
+        bool hedge = false;
+        double hedgeQuantile = 0.95;
+        // Lower bound on the hedge delay, and the delay used until
+        // minHedgeSamples calls have been timed
+        std::chrono::milliseconds minHedgeDelay{10};
+        uint32_t minHedgeSamples = 50;
+    };
+
+    struct Metrics {
+        std::vector<int> outstanding;  // per replica
+        uint64_t hedged = 0;           // calls that sent a second copy
+        uint64_t hedgeWins = 0;        // ... where the second copy answered first
+        std::chrono::microseconds hedgeDelay{0};
+    };
+
+private:
+    struct Replica {
+        std::atomic<int> outstanding{0};
+        // Declared last: settles still in flight during teardown touch outstanding
+        std::unique_ptr<mcp> client;
+    };
+
+    // Shared by the copies of one call; settles wake the caller
+    struct Race {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int settled = 0;
+
+        void notify() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++settled;
+            }
+            cv.notify_all();
+        }
+    };
+
+    struct Attempt {
+        size_t replica;
+        int id;
+        std::future<nlohmann::json> result;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    type::McpServerConfig config;
+    Options options;
+    std::vector<std::unique_ptr<Replica>> replicas;
+    std::atomic<size_t> rotation{0};
+    std::mutex rngMutex;
+    std::minstd_rand rng{std::random_device{}()};
+
+    LatencyTracker latency;
+    std::atomic<uint64_t> hedged{0};
+    std::atomic<uint64_t> hedgeWins{0};
+
+    std::mutex hedgeableMutex;
+    std::set<std::string, std::less<>> hedgeable;  // listed names; never interned
+
+    bool available(size_t i) const {
+        return replicas[i]->client->breakerState() != CircuitBreaker::State::Open;
+    }
+
+    // Replica for the next call, other than `exclude`; SIZE_MAX if none
+    size_t pick(size_t exclude = SIZE_MAX) {
+        const size_t n = replicas.size();
+        std::vector<size_t> candidates;
+        candidates.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (i != exclude && available(i)) candidates.push_back(i);
+        }
+        if (candidates.empty()) {
+            // All open: let a breaker fail the call fast, or probe
+            for (size_t i = 0; i < n; ++i) {
+                if (i != exclude) candidates.push_back(i);
+            }
+            if (candidates.empty()) return SIZE_MAX;
+        }
+        auto load = [this](size_t i) { return replicas[i]->outstanding.load(std::memory_order_relaxed); };
+
+        if (options.balance == Balance::PowerOfTwoChoices && candidates.size() > 2) {
+            size_t a, b;
+            {
+                std::lock_guard<std::mutex> lock(rngMutex);
+                std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+                a = dist(rng);
+                b = dist(rng);
+                while (b == a) b = dist(rng);
+            }
+            return load(candidates[b]) < load(candidates[a]) ? candidates[b] : candidates[a];
+        }
+        // Least outstanding; ties go round-robin
+        const size_t start = rotation++ % candidates.size();
+        size_t best = candidates[start];
+        for (size_t k = 1; k < candidates.size(); ++k) {
+            const size_t i = candidates[(start + k) % candidates.size()];
+            if (load(i) < load(best)) best = i;
+        }
+        return best;
+    }
+
+    // Starts one copy; `outstanding` drops when it settles
+    template <class Send>
+    Attempt launch(size_t replica, const CallOptions& options, const std::shared_ptr<Race>& race, Send&& send) {
+        Replica& r = *replicas[replica];
+        CallOptions opts = options;
+        opts.onSettled = [&r, race, user = options.onSettled]() {
+            r.outstanding.fetch_sub(1, std::memory_order_relaxed);
+            if (race) race->notify();
+            if (user) user();
+        };
+        r.outstanding.fetch_add(1, std::memory_order_relaxed);
+        try {
+            const auto sentAt = std::chrono::steady_clock::now();
+            auto [id, future] = send(*r.client, opts);
+            return Attempt{replica, id, std::move(future), sentAt};
+        } catch (...) {
+            // Rejected before sending (circuit open, invalid arguments)
+            r.outstanding.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    static bool ready(const Attempt& a) {
+        return a.result.valid() && a.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    std::chrono::microseconds hedgeDelay() {
+        const std::chrono::microseconds floor = options.minHedgeDelay;
+        if (latency.samples() < options.minHedgeSamples) {
+            return floor;
+        }
+        return std::max(latency.quantile(options.hedgeQuantile), floor);
+    }
+
+    template <class Send>
+    nlohmann::json run(const std::string& method, bool mayHedge, const CallOptions& requested, Send send) {
+        const auto started = std::chrono::steady_clock::now();
+        const auto deadline = std::min({requested.deadline, currentDeadline(),
+                                        started + std::chrono::milliseconds(config.requestTimeoutMs)});
+        // Every copy carries the caller's deadline; each client adds its own
+        // requestTimeoutMs, so a copy that runs out of it counts against
+        // that replica's breaker
+        CallOptions callOptions = requested;
+        callOptions.deadline = std::min(requested.deadline, currentDeadline());
+        const bool hedging = mayHedge && options.hedge && replicas.size() > 1;
+        auto race = hedging ? std::make_shared<Race>() : nullptr;
+
+        std::vector<Attempt> attempts;
+        attempts.push_back(launch(pick(), callOptions, race, send));
+
+        if (hedging) {
+            std::unique_lock<std::mutex> lock(race->mutex);
+            race->cv.wait_until(lock, std::min(deadline, started + hedgeDelay()), [&] { return race->settled > 0; });
+            const bool slow = race->settled == 0;
+            lock.unlock();
+            const size_t second = slow ? pick(attempts[0].replica) : SIZE_MAX;
+            if (second != SIZE_MAX && std::chrono::steady_clock::now() < deadline) {
+                try {
+                    attempts.push_back(launch(second, callOptions, race, send));
+                    ++hedged;
+                } catch (const RpcError&) {
+                    // Second replica refused; keep waiting on the first
+                }
+            }
+        }
+
+        // First success wins; an error only once every copy has failed
+        std::exception_ptr firstError;
+        size_t open = attempts.size();
+        while (open > 0) {
+            Attempt* done = nullptr;
+            if (race) {
+                std::unique_lock<std::mutex> lock(race->mutex);
+                race->cv.wait_until(lock, deadline, [&] {
+                    for (auto& a : attempts) {
+                        if (ready(a)) return true;
+                    }
+                    return false;
+                });
+            } else {
+                attempts[0].result.wait_until(deadline);
+            }
+            for (auto& a : attempts) {
+                if (ready(a)) {
+                    done = &a;
+                    break;
+                }
+            }
+            if (!done) {
+                for (auto& a : attempts) {
+                    if (a.result.valid()) replicas[a.replica]->client->expire(a.id);
+                }
+                throw RpcError(JsonRpc::RequestTimeout, "Request timed out: " + method);
+            }
+            --open;
+            try {
+                auto value = done->result.get();
+                // The winning copy's own round trip, without the hedge delay
+                latency.record(std::chrono::steady_clock::now() - done->sentAt);
+                if (done != &attempts[0]) ++hedgeWins;
+                for (auto& a : attempts) {
+                    if (a.result.valid()) replicas[a.replica]->client->cancel(a.id, "Superseded by a hedged request");
+                }
+                return value;
+            } catch (...) {
+                if (!firstError) firstError = std::current_exception();
+            }
+        }
+        std::rethrow_exception(firstError);
+    }
+
+public:
+    ReplicaSet(std::vector<std::unique_ptr<Transport>> transports, const type::McpServerConfig& cfg)
+        : ReplicaSet(std::move(transports), cfg, Options{}) {}
+
+    ReplicaSet(std::vector<std::unique_ptr<Transport>> transports, const type::McpServerConfig& cfg,
+               const Options& opts, std::shared_ptr<Executor> executor = Executor::shared())
+        : config(cfg), options(opts) {
+        if (transports.empty()) {
+            throw std::invalid_argument("ReplicaSet needs at least one transport");
+        }
+        replicas.reserve(transports.size());
+        for (auto& t : transports) {
+            auto r = std::make_unique<Replica>();
+            r->client = std::make_unique<mcp>(std::move(t), cfg, executor);
+            replicas.push_back(std::move(r));
+        }
+    }
+
+    size_t size() const { return replicas.size(); }
+    mcp& replica(size_t i) { return *replicas[i]->client; }
+
+    // Registers a server-initiated request or notification handler on
+    // every replica. Call before start().
+    template <class T, class Handler>
+    void on(const Handler& handler) {
+        for (auto& r : replicas) r->client->template on<T>(handler);
+    }
+
+    void start() {
+        for (auto& r : replicas) r->client->start();
+    }
+
+    void stop() {
+        for (auto& r : replicas) r->client->stop();
+    }
+
+    // Sends the request to every replica and waits for all, e.g. initialize.
+    // The replicas share one requestTimeoutMs deadline; those that have not
+    // answered by then are withdrawn.
+    std::vector<nlohmann::json> broadcast(const std::string& method, const nlohmann::json& params) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.requestTimeoutMs);
+        std::vector<std::pair<int, std::future<nlohmann::json>>> calls;
+        calls.reserve(replicas.size());
+        for (auto& r : replicas) calls.push_back(r->client->callWithId(method, params));
+        std::vector<nlohmann::json> results;
+        results.reserve(calls.size());
+        // Calls not waited for any more are withdrawn, not left in flight
+        size_t i = 0;
+        try {
+            for (; i < calls.size(); ++i) {
+                auto& f = calls[i].second;
+                if (f.wait_until(deadline) != std::future_status::ready) {
+                    throw RpcError(JsonRpc::RequestTimeout, "Request timed out: " + method);
+                }
+                results.push_back(f.get());
+            }
+        } catch (...) {
+            for (; i < calls.size(); ++i) replicas[i]->client->expire(calls[i].first);
+            throw;
+        }
+        return results;
+    }
+
+    // Balanced, never hedged: the method's side effects are unknown
+    nlohmann::json call(const std::string& method, const nlohmann::json& params, const CallOptions& options = {}) {
+        return run(method, false, options, [&](mcp& client, const CallOptions& opts) {
+            return client.callWithId(method, params, opts);
+        });
+    }
+
+    std::future<nlohmann::json> callAsync(const std::string& method, const nlohmann::json& params,
+                                          const CallOptions& options = {}) {
+        return launch(pick(), options, nullptr, [&](mcp& client, const CallOptions& opts) {
+            return client.callWithId(method, params, opts);
+        }).result;
+    }
+
+    // Hedged when the tool was listed as read-only or idempotent
+    nlohmann::json callTool(type::Symbol name, const nlohmann::json& arguments, const CallOptions& options = {}) {
+        bool mayHedge;
+        {
+            std::lock_guard<std::mutex> lock(hedgeableMutex);
+            mayHedge = hedgeable.count(name.view()) > 0;
+        }
+        return run(std::string(type::CallToolRequest::Method), mayHedge, options,
+                   [&](mcp& client, const CallOptions& opts) { return client.callToolWithId(name, arguments, opts); });
+    }
+
+    // Lists through one replica; the tools' annotations decide which calls
+    // may be hedged. Every replica is assumed to serve the same tools.
+    ListRange<type::ListToolsRequest> listTools() {
+        return replicas[pick()]->client->listTools([this](const std::vector<type::Tool>& tools) {
+            std::lock_guard<std::mutex> lock(hedgeableMutex);
+            for (const auto& t : tools) {
+                const auto& a = t.annotations;
+                if (a && ((a->readOnlyHint && *a->readOnlyHint) || (a->idempotentHint && *a->idempotentHint))) {
+                    hedgeable.insert(t.name);
+                } else {
+                    hedgeable.erase(t.name);
+                }
+            }
+        });
+    }
+
+    Metrics metrics() {
+        Metrics m;
+        for (auto& r : replicas) m.outstanding.push_back(r->outstanding.load());
+        m.hedged = hedged.load();
+        m.hedgeWins = hedgeWins.load();
+        m.hedgeDelay = hedgeDelay();
+        return m;
+    }
+};
+
+} // namespace mcp
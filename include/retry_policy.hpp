@@ -0,0 +1,220 @@
+#pragma once
+#include "jsonrpc.hpp"
+#include "deadline.hpp"
+#include "transport/backoff.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace mcp {
+
+// ============================================================================
+// RetryBudget
+// ============================================================================
+//
+// Caps retries at a fraction of first attempts. Every call deposits `ratio`
+// of a token and every retry withdraws a whole one, so while an upstream
+// fails everything, retries add at most `ratio` to the load on it instead
+// of multiplying it by the attempt count. The budget starts full at
+// `reserve` tokens, which is also its ceiling, so a quiet client can still
+// retry a lone failure. The balance is one atomic.
+
+class RetryBudget {
+    static constexpr int64_t Unit = 1000;  // milli-tokens per token
+
+    std::atomic<int64_t> deposit;
+    std::atomic<int64_t> cap;
+    std::atomic<int64_t> balance;
+    std::atomic<uint64_t> denied{0};
+
+public:
+    explicit RetryBudget(double ratio = 0.1, double reserve = 10)
+        : deposit(static_cast<int64_t>(std::max(ratio, 0.0) * Unit)),
+          cap(static_cast<int64_t>(std::max(reserve, 1.0) * Unit)),
+          balance(cap.load()) {}
+
+    RetryBudget(const RetryBudget&) = delete;
+    RetryBudget& operator=(const RetryBudget&) = delete;
+
+    void configure(double ratio, double reserve) {
+        deposit.store(static_cast<int64_t>(std::max(ratio, 0.0) * Unit), std::memory_order_relaxed);
+        cap.store(static_cast<int64_t>(std::max(reserve, 1.0) * Unit), std::memory_order_relaxed);
+    }
+
+    // A call's first attempt
+    void attempted() {
+        const int64_t limit = cap.load(std::memory_order_relaxed);
+        const int64_t add = deposit.load(std::memory_order_relaxed);
+        int64_t current = balance.load(std::memory_order_relaxed);
+        while (current < limit &&
+               !balance.compare_exchange_weak(current, std::min(current + add, limit), std::memory_order_relaxed)) {
+        }
+    }
+
+    // Takes a token for one retry; false when the budget is spent
+    bool tryRetry() {
+        int64_t current = balance.load(std::memory_order_relaxed);
+        do {
+            if (current < Unit) {
+                denied.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!balance.compare_exchange_weak(current, current - Unit, std::memory_order_relaxed));
+        return true;
+    }
+
+    void refund() {
+        balance.fetch_add(Unit, std::memory_order_relaxed);
+    }
+
+    // Retries refused for lack of budget
+    uint64_t exhausted() const {
+        return denied.load(std::memory_order_relaxed);
+    }
+
+    // Shared by every server in the process, on top of each server's own,
+    // so an outage across many servers cannot multiply load either
+    static RetryBudget& global() {
+        static RetryBudget budget(0.1, 100);
+        return budget;
+    }
+};
+
+// ============================================================================
+// RetryPolicy
+// ============================================================================
+//
+// Decides whether a failed call is sent again, and after how long. A call
+// is retried when
+//
+//   - it never reached the server (no connection could be made), whatever
+//     it was; or
+//   - it is idempotent (a method in safeMethod(), or a tool annotated
+//     readOnlyHint or idempotentHint) and failed in a way another attempt
+//     can fix: lost connection, timeout, HTTP 408/429/5xx, ServerBusy or
+//     InternalError;
+//
+// and it has attempts left, the server's budget and the global one both
+// have a token, and the delay still fits before the call's deadline.
+// Answers about the request itself (InvalidParams, MethodNotFound, tool
+// errors) and local refusals (open circuit, shed, rate-limited) are final.
+// Delays follow Backoff, or the server's Retry-After when longer.
+
+class RetryPolicy {
+public:
+    enum class ErrorClass : uint8_t { NotSent, Transient, Permanent };
+
+    struct Options {
+        bool enabled = false;
+        int maxAttempts = 3;  // first attempt included
+        std::chrono::milliseconds baseDelay{50};
+        std::chrono::milliseconds maxDelay{2000};
+        double budgetRatio = 0.1;
+        double budgetReserve = 10;
+    };
+
+    struct Metrics {
+        uint64_t retries = 0;
+        uint64_t exhausted = 0;  // refused by this server's budget or the global one
+    };
+
+private:
+    Options options;
+    RetryBudget budget;
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint64_t> globalDenied{0};
+
+public:
+    RetryPolicy() : RetryPolicy(Options{}) {}
+
+    explicit RetryPolicy(const Options& opts)
+        : options(opts), budget(opts.budgetRatio, opts.budgetReserve) {
+        options.maxAttempts = std::max(options.maxAttempts, 1);
+    }
+
+    bool enabled() const { return options.enabled; }
+
+    // Requests that change nothing on the server, so a duplicate is harmless
+    static bool safeMethod(std::string_view method) {
+        static constexpr std::array<std::string_view, 12> safe = {
+            "ping", "tools/list", "prompts/list", "prompts/get", "resources/list", "resources/templates/list",
+            "resources/read", "resources/subscribe", "resources/unsubscribe", "completion/complete",
+            "logging/setLevel", "roots/list"};
+        return std::find(safe.begin(), safe.end(), method) != safe.end();
+    }
+
+    static ErrorClass classify(const RpcError& e) {
+        switch (e.code) {
+            case JsonRpc::TransportFailed: {
+                if (!e.data.value("delivered", true)) {
+                    return ErrorClass::NotSent;
+                }
+                const int status = e.data.value("status", 0);
+                return status == 0 || status == 408 || status == 429 || status >= 500 ? ErrorClass::Transient
+                                                                                       : ErrorClass::Permanent;
+            }
+            case JsonRpc::ConnectionClosed:
+            case JsonRpc::RequestTimeout:
+            case JsonRpc::ServerBusy:
+            case JsonRpc::InternalError:
+                return ErrorClass::Transient;
+            default:
+                return ErrorClass::Permanent;
+        }
+    }
+
+    // Once per call, before its first attempt
+    void attempted() {
+        if (options.enabled) {
+            budget.attempted();
+            RetryBudget::global().attempted();
+        }
+    }
+
+    // After attempt number `attempt` (from 1) failed with `e`: the delay
+    // before the next one, or nullopt to give up. `backoff` is the call's.
+    std::optional<std::chrono::milliseconds> retryAfter(int attempt, const RpcError& e, bool idempotent,
+                                                        Backoff& backoff, Deadline deadline) {
+        if (!options.enabled || attempt >= options.maxAttempts) {
+            return std::nullopt;
+        }
+        const auto kind = classify(e);
+        if (kind == ErrorClass::Permanent || (kind == ErrorClass::Transient && !idempotent)) {
+            return std::nullopt;
+        }
+        auto delay = backoff.next();
+        if (e.code == JsonRpc::TransportFailed) {
+            delay = std::max(delay, std::chrono::milliseconds(e.data.value("retryAfterMs", int64_t(0))));
+        }
+        if (remainingMs(deadline, std::chrono::steady_clock::now()) <= delay.count()) {
+            return std::nullopt;
+        }
+        if (!budget.tryRetry()) {
+            return std::nullopt;
+        }
+        if (!RetryBudget::global().tryRetry()) {
+            budget.refund();
+            globalDenied.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        retries.fetch_add(1, std::memory_order_relaxed);
+        return delay;
+    }
+
+    Backoff backoff() const {
+        return Backoff(options.baseDelay, options.maxDelay, options.baseDelay);
+    }
+
+    Metrics metrics() const {
+        Metrics m;
+        m.retries = retries.load(std::memory_order_relaxed);
+        m.exhausted = budget.exhausted() + globalDenied.load(std::memory_order_relaxed);
+        return m;
+    }
+};
+
+} // namespace mcp
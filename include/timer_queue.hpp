@@ -0,0 +1,104 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace mcp {
+
+// ============================================================================
+// TimerQueue
+// ============================================================================
+//
+// One thread running callbacks at given times: deadlines of suspended
+// calls, trailing progress deliveries. A thousand pending timers cost a
+// thousand map entries, not a thousand blocked threads. Callbacks run on
+// the timer thread and must be short; hand real work to an Executor.
+
+class TimerQueue {
+    using Clock = std::chrono::steady_clock;
+
+public:
+    struct Timer {
+        Clock::time_point when;
+        uint64_t id = 0;
+    };
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<std::pair<Clock::time_point, uint64_t>, std::function<void()>> timers;
+    uint64_t nextId = 1;
+    bool stopping = false;
+    std::thread thread;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (timers.empty()) {
+                changed.wait(lock);
+                continue;
+            }
+            auto first = timers.begin();
+            // A copy: cancel() may erase the entry while this sleeps
+            const auto due = first->first.first;
+            if (due > Clock::now()) {
+                changed.wait_until(lock, due);
+                continue;
+            }
+            auto fire = std::move(first->second);
+            timers.erase(first);
+            lock.unlock();
+            fire();
+            lock.lock();
+        }
+    }
+
+public:
+    TimerQueue() : thread([this] { run(); }) {}
+
+    // Drops the timers that have not fired
+    ~TimerQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_one();
+        thread.join();
+    }
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    Timer at(Clock::time_point when, std::function<void()> fire) {
+        bool earliest;
+        Timer timer{when, 0};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            timer.id = nextId++;
+            auto it = timers.emplace(std::make_pair(when, timer.id), std::move(fire)).first;
+            earliest = it == timers.begin();
+        }
+        if (earliest) {
+            changed.notify_one();
+        }
+        return timer;
+    }
+
+    // False if the timer already fired or was cancelled
+    bool cancel(const Timer& timer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return timers.erase({timer.when, timer.id}) > 0;
+    }
+
+    static TimerQueue& shared() {
+        static TimerQueue instance;
+        return instance;
+    }
+};
+
+} // namespace mcp
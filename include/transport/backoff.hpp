@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace mcp {
+
+// ============================================================================
+// Reconnect Backoff
+// ============================================================================
+//
+// Exponential backoff with decorrelated jitter: the first retry comes after
+// a short random delay in [0, first]; each later delay is drawn uniformly
+// from [base, 3 * previous delay], capped at `cap`. Clients that lost the
+// same upstream at the same moment spread out instead of reconnecting in
+// lockstep, while a lone blip is retried almost at once.
+
+class Backoff {
+    std::chrono::milliseconds first;
+    std::chrono::milliseconds base;
+    std::chrono::milliseconds cap;
+    std::chrono::milliseconds previous{0};
+    bool started = false;
+    std::minstd_rand rng{std::random_device{}()};
+
+    std::chrono::milliseconds uniform(std::chrono::milliseconds lo, std::chrono::milliseconds hi) {
+        if (hi <= lo) return lo;
+        std::uniform_int_distribution<int64_t> pick(lo.count(), hi.count());
+        return std::chrono::milliseconds(pick(rng));
+    }
+
+public:
+    Backoff(std::chrono::milliseconds base, std::chrono::milliseconds cap,
+            std::chrono::milliseconds first = std::chrono::milliseconds(100))
+        : first(std::max(first, std::chrono::milliseconds(0))),
+          base(std::max(base, std::chrono::milliseconds(1))),
+          cap(std::max(cap, this->base)) {}
+
+    std::chrono::milliseconds next() {
+        if (!started) {
+            started = true;
+            previous = base;
+            return uniform(std::chrono::milliseconds(0), std::min(first, cap));
+        }
+        previous = uniform(base, std::min(cap, previous * 3));
+        return previous;
+    }
+
+    // After a successful connection
+    void reset() {
+        started = false;
+        previous = std::chrono::milliseconds(0);
+    }
+};
+
+} // namespace mcp
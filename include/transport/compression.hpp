@@ -0,0 +1,69 @@
+#pragma once
+#include <httplib.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp {
+
+// ============================================================================
+// HTTP Content Coding
+// ============================================================================
+//
+// Opt-in, per server. HttpConfig/SseConfig::acceptEncodings lists the codings
+// to offer in Accept-Encoding, most preferred first; codings this httplib
+// build cannot decode are dropped. httplib inflates responses chunk by chunk
+// before the content receiver sees them, so a compressed event stream is
+// fed to the incremental SSE parser as it arrives and never buffered whole.
+// Request bodies of at least compressRequestBytes are sent gzip-encoded.
+//
+//     config.acceptEncodings = {"zstd", "gzip"};
+//     config.compressRequestBytes = 16 * 1024;
+
+inline bool compressionAvailable(std::string_view coding) {
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+    if (coding == "gzip" || coding == "deflate") return true;
+#endif
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+    if (coding == "br") return true;
+#endif
+#ifdef CPPHTTPLIB_ZSTD_SUPPORT
+    if (coding == "zstd") return true;
+#endif
+    (void)coding;
+    return false;
+}
+
+// Accept-Encoding value for the available codings; empty if none is
+inline std::string acceptEncodingHeader(const std::vector<std::string>& codings) {
+    std::string header;
+    for (size_t i = 0; i < codings.size(); ++i) {
+        const auto& c = codings[i];
+        if (!compressionAvailable(c)) continue;
+        bool repeated = false;
+        for (size_t j = 0; j < i; ++j) repeated = repeated || codings[j] == c;
+        if (repeated) continue;
+        if (!header.empty()) header += ", ";
+        header += c;
+    }
+    return header;
+}
+
+// Applies the coding settings to one request. Returns whether the body
+// will be compressed.
+inline bool applyCompression(httplib::Client& cli, httplib::Headers& headers,
+                             const std::vector<std::string>& acceptEncodings,
+                             size_t compressRequestBytes, size_t bodySize = 0) {
+    // Explicit identity so a zlib-enabled httplib does not offer gzip on its own
+    const std::string accept = acceptEncodingHeader(acceptEncodings);
+    headers.emplace("Accept-Encoding", accept.empty() ? "identity" : accept);
+    cli.set_decompress(!accept.empty());
+
+    const bool compressBody = compressRequestBytes > 0 && bodySize >= compressRequestBytes &&
+                              compressionAvailable("gzip");
+    cli.set_compress(compressBody);
+    return compressBody;
+}
+
+} // namespace mcp
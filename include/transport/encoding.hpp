@@ -0,0 +1,102 @@
+#pragma once
+#include "../type/schema.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// ============================================================================
+// Wire Encoding
+// ============================================================================
+//
+// JSON text is the default and always available. Peers that both advertise
+// it under capabilities.experimental["binaryEncoding"] during initialize can
+// switch to CBOR or MessagePack; the message content is the same JSON-RPC
+// object, only its byte representation changes.
+//
+//     client:  "experimental": {"binaryEncoding": {"encodings": ["cbor", "msgpack"]}}
+//     server:  "experimental": {"binaryEncoding": {"encodings": ["msgpack"]}}
+//
+// The client picks the first of its own encodings that the server lists.
+
+enum class WireEncoding : uint8_t { Json, Cbor, MsgPack };
+
+inline constexpr std::string_view BinaryEncodingCapability = "binaryEncoding";
+
+inline std::string_view encodingName(WireEncoding e) {
+    switch (e) {
+        case WireEncoding::Cbor: return "cbor";
+        case WireEncoding::MsgPack: return "msgpack";
+        default: return "json";
+    }
+}
+
+inline bool parseEncoding(std::string_view name, WireEncoding& out) {
+    if (name == "json") out = WireEncoding::Json;
+    else if (name == "cbor") out = WireEncoding::Cbor;
+    else if (name == "msgpack") out = WireEncoding::MsgPack;
+    else return false;
+    return true;
+}
+
+inline std::string_view contentType(WireEncoding e) {
+    switch (e) {
+        case WireEncoding::Cbor: return "application/cbor";
+        case WireEncoding::MsgPack: return "application/msgpack";
+        default: return "application/json";
+    }
+}
+
+// Encodes one message. JSON callers normally use the JsonRpc writers instead.
+inline std::string encode(const nlohmann::json& message, WireEncoding e) {
+    std::string out;
+    switch (e) {
+        case WireEncoding::Cbor: nlohmann::json::to_cbor(message, out); break;
+        case WireEncoding::MsgPack: nlohmann::json::to_msgpack(message, out); break;
+        default: out = message.dump(); break;
+    }
+    return out;
+}
+
+inline nlohmann::json decode(std::string_view bytes, WireEncoding e) {
+    switch (e) {
+        case WireEncoding::Cbor: return nlohmann::json::from_cbor(bytes.begin(), bytes.end());
+        case WireEncoding::MsgPack: return nlohmann::json::from_msgpack(bytes.begin(), bytes.end());
+        default: return nlohmann::json::parse(bytes.begin(), bytes.end());
+    }
+}
+
+// Re-encodes a serialized JSON message; a no-op for JSON
+inline std::string transcode(std::string jsonText, WireEncoding e) {
+    return e == WireEncoding::Json ? std::move(jsonText) : encode(nlohmann::json::parse(jsonText), e);
+}
+
+namespace type {
+
+inline void advertiseEncodings(ClientCapabilities& caps, const std::vector<WireEncoding>& preferred) {
+    nlohmann::json names = nlohmann::json::array();
+    for (auto e : preferred) names.push_back(encodingName(e));
+    if (!caps.experimental) caps.experimental.emplace();
+    (*caps.experimental)[std::string(BinaryEncodingCapability)] = {{"encodings", std::move(names)}};
+}
+
+// First of `preferred` that the server also lists; JSON otherwise
+inline WireEncoding negotiateEncoding(const std::vector<WireEncoding>& preferred, const ServerCapabilities& server) {
+    if (!server.experimental) return WireEncoding::Json;
+    auto it = server.experimental->find(std::string(BinaryEncodingCapability));
+    if (it == server.experimental->end() || !it->second.is_object()) return WireEncoding::Json;
+    auto list = it->second.find("encodings");
+    if (list == it->second.end() || !list->is_array()) return WireEncoding::Json;
+    for (auto e : preferred) {
+        for (const auto& name : *list) {
+            if (name.is_string() && name.get_ref<const std::string&>() == encodingName(e)) return e;
+        }
+    }
+    return WireEncoding::Json;
+}
+
+} // namespace type
+} // namespace mcp
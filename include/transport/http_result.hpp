@@ -0,0 +1,33 @@
+#pragma once
+#include "transport.hpp"
+#include <httplib.h>
+#include <cctype>
+#include <chrono>
+#include <string>
+
+namespace mcp {
+
+// Turns a failed POST into a TransportError. Only a failed connect is
+// known not to have reached the server; a request cut off while writing or
+// reading may have been run.
+inline void throwIfFailed(const httplib::Result& res, const std::string& url) {
+    if (!res) {
+        const auto error = res.error();
+        throw TransportError("POST to " + url + " failed: " + httplib::to_string(error), 0,
+                             error != httplib::Error::Connection);
+    }
+    if (res->status < 400) {
+        return;
+    }
+    // Retry-After in seconds; the HTTP-date form is not honoured
+    std::chrono::milliseconds retryAfter(0);
+    const auto value = res->get_header_value("Retry-After");
+    if (!value.empty() && value.size() < 9 && std::isdigit(static_cast<unsigned char>(value[0]))) {
+        retryAfter = std::chrono::seconds(std::stol(value));
+    }
+    throw TransportError("POST to " + url + " refused with HTTP " + std::to_string(res->status) +
+                             (res->body.empty() ? "" : ": " + res->body),
+                         res->status, true, retryAfter);
+}
+
+} // namespace mcp
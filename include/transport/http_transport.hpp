@@ -1,5 +1,7 @@
 #pragma once
 #include "transport.hpp"
+#include "compression.hpp"
+#include "http_result.hpp"
 #include "type/mcp_type.hpp"
 #include <httplib.h>
 
@@ -17,7 +19,9 @@ public:
 
     void send(const std::string& message) override {
         httplib::Client cli(config.baseUrl);
-        cli.Post(config.baseUrl.c_str(), message, "application/json");
+        httplib::Headers headers(config.headers.begin(), config.headers.end());
+        applyCompression(cli, headers, config.acceptEncodings, config.compressRequestBytes, message.size());
+        throwIfFailed(cli.Post(config.baseUrl.c_str(), headers, message, "application/json"), config.baseUrl);
     }
 
     void start(MessageHandler) override {
@@ -0,0 +1,352 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "encoding.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MCP_SPILL_MMAP 1
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace mcp {
+
+// ============================================================================
+// SpillFile
+// ============================================================================
+//
+// Unlinked temporary file that an oversized inbound payload is streamed
+// into, then mapped read-only. Mapped pages are file-backed and reclaimable,
+// so a huge message does not pin its size in RSS. Without mmap support the
+// payload is kept in memory.
+
+class SpillFile {
+#ifdef MCP_SPILL_MMAP
+    int fd = -1;
+    void* mapping = nullptr;
+#else
+    std::string memory;
+#endif
+    size_t length = 0;
+
+public:
+    explicit SpillFile(const std::string& directory) {
+#ifdef MCP_SPILL_MMAP
+        std::string dir = directory.empty() ? std::filesystem::temp_directory_path().string() : directory;
+        std::string path = dir + "/mcp-spill-XXXXXX";
+        fd = ::mkstemp(path.data());
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create spill file in " + dir + ": " + std::strerror(errno));
+        }
+        ::unlink(path.c_str());
+#else
+        (void)directory;
+#endif
+    }
+
+    ~SpillFile() {
+#ifdef MCP_SPILL_MMAP
+        if (mapping) ::munmap(mapping, length);
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    void append(const char* data, size_t size) {
+#ifdef MCP_SPILL_MMAP
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("Spill file write failed: ") + std::strerror(errno));
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            length += static_cast<size_t>(n);
+        }
+#else
+        memory.append(data, size);
+        length += size;
+#endif
+    }
+
+    // Maps the file; no appends after this
+    void seal() {
+#ifdef MCP_SPILL_MMAP
+        if (length > 0 && !mapping) {
+            void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                throw std::runtime_error(std::string("Spill file mmap failed: ") + std::strerror(errno));
+            }
+            mapping = p;
+        }
+#endif
+    }
+
+    std::string_view view() const {
+#ifdef MCP_SPILL_MMAP
+        return mapping ? std::string_view(static_cast<const char*>(mapping), length) : std::string_view();
+#else
+        return memory;
+#endif
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
+
+// ============================================================================
+// SpilledDocument
+// ============================================================================
+//
+// A spilled message parsed by Message::parseDeferred(): the json tree, with
+// the string value of each "data" or "blob" member (base64 image, audio and
+// blob content) over the inline limit left in the mapped file instead of
+// copied. Such a value is a json binary value of subtype Subtype holding an
+// index into this document's own slices; payload() turns it back into the
+// bytes. Only values without escapes are deferred, so the mapped bytes are
+// exactly the string.
+//
+// The document owns the file: references resolve only through the document
+// that made them, for as long as it or a copy lives. JSON text has no
+// binary values, so nothing a peer sent is ever taken for a reference.
+
+class SpilledDocument {
+public:
+    static constexpr uint8_t Subtype = 0x53;
+
+    nlohmann::json json;
+
+    // The payload string: the mapped bytes of a deferred value, or a plain
+    // string value itself
+    std::string_view payload(const nlohmann::json& value) const {
+        if (value.is_string()) {
+            return value.get_ref<const std::string&>();
+        }
+        if (file && value.is_binary()) {
+            const auto& reference = value.get_binary();
+            if (reference.has_subtype() && reference.subtype() == Subtype && reference.size() == sizeof(uint64_t)) {
+                uint64_t index = 0;
+                std::memcpy(&index, reference.data(), sizeof index);
+                if (index < slices.size()) {
+                    return file->view().substr(slices[index].first, slices[index].second);
+                }
+            }
+        }
+        throw std::invalid_argument("Not a payload of this document");
+    }
+
+private:
+    friend class Message;
+
+    std::shared_ptr<const SpillFile> file;
+    std::vector<std::pair<size_t, size_t>> slices;  // offset and length in the file
+    // Per parse, so a string in the message cannot pose as a placeholder
+    std::string nonce;
+
+    static std::string makeNonce() {
+        std::random_device random;
+        std::string nonce;
+        for (int i = 0; i < 4; ++i) {
+            nonce += std::to_string(random());
+        }
+        return nonce;
+    }
+};
+
+// ============================================================================
+// Message
+// ============================================================================
+//
+// One inbound JSON-RPC message as delivered by a transport: either an owned
+// string or a spilled, memory-mapped payload, in JSON text or a negotiated
+// binary encoding.
+
+class Message {
+    std::string text;
+    std::shared_ptr<const SpillFile> file;
+    WireEncoding wireEncoding = WireEncoding::Json;
+
+public:
+    Message() = default;
+    Message(std::string s) : text(std::move(s)) {}
+    Message(const char* s) : text(s) {}
+    Message(std::string bytes, WireEncoding e) : text(std::move(bytes)), wireEncoding(e) {}
+
+    explicit Message(std::shared_ptr<SpillFile> spilled) {
+        spilled->seal();
+        file = std::move(spilled);
+    }
+
+    std::string_view view() const {
+        return file ? file->view() : std::string_view(text);
+    }
+
+    size_t size() const {
+        return file ? file->size() : text.size();
+    }
+
+    bool spilled() const {
+        return file != nullptr;
+    }
+
+    WireEncoding encoding() const {
+        return wireEncoding;
+    }
+
+    // Parses the message into an ordinary json tree; a spilled payload is
+    // parsed straight from the mapping.
+    nlohmann::json parse() const {
+        const auto v = view();
+        if (wireEncoding != WireEncoding::Json) {
+            return decode(v, wireEncoding);
+        }
+        return nlohmann::json::parse(v.begin(), v.end());
+    }
+
+    // Parses the message, leaving the large base64 payloads of a spilled
+    // JSON message in the mapped file; see SpilledDocument
+    SpilledDocument parseDeferred(size_t inlineLimit = 64 * 1024) const {
+        SpilledDocument doc;
+        if (!file || wireEncoding != WireEncoding::Json) {
+            doc.json = parse();
+            return doc;
+        }
+
+        doc.nonce = SpilledDocument::makeNonce();
+        const auto v = view();
+        const auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+        std::string skeleton;
+        size_t copied = 0;
+        size_t valueAt = std::string_view::npos;  // start of the value of a "data" or "blob" member
+        size_t i = 0;
+        while (i < v.size()) {
+            if (v[i] != '"') {
+                ++i;
+                continue;
+            }
+            const size_t start = i + 1;
+            size_t j = start;
+            bool escaped = false;
+            while (j < v.size() && v[j] != '"') {
+                if (v[j] == '\\') {
+                    escaped = true;
+                    ++j;
+                }
+                ++j;
+            }
+            size_t k = j + 1;
+            while (k < v.size() && isSpace(v[k])) ++k;
+            if (k < v.size() && v[k] == ':') {
+                const auto key = v.substr(start, j - start);
+                valueAt = std::string_view::npos;
+                if (key == "data" || key == "blob") {
+                    valueAt = k + 1;
+                    while (valueAt < v.size() && isSpace(v[valueAt])) ++valueAt;
+                }
+                i = k + 1;
+                continue;
+            }
+            if (i == valueAt && !escaped && j < v.size() && j - start > inlineLimit) {
+                skeleton.append(v.data() + copied, i - copied);
+                skeleton += "\"\\u0001" + doc.nonce + ":" + std::to_string(doc.slices.size()) + "\"";
+                doc.slices.emplace_back(start, j - start);
+                copied = j + 1;
+            }
+            valueAt = std::string_view::npos;
+            i = j + 1;
+        }
+        if (doc.slices.empty()) {
+            doc.json = parse();
+            return doc;
+        }
+        skeleton.append(v.data() + copied, v.size() - copied);
+
+        doc.file = file;
+        const std::string placeholder = "\x01" + doc.nonce + ":";
+        doc.json = nlohmann::json::parse(
+            skeleton, [&](int, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+                if (event == nlohmann::json::parse_event_t::value && parsed.is_string()) {
+                    const auto& value = parsed.get_ref<const std::string&>();
+                    if (value.compare(0, placeholder.size(), placeholder) == 0) {
+                        const uint64_t index = std::stoull(value.substr(placeholder.size()));
+                        std::vector<uint8_t> reference(sizeof index);
+                        std::memcpy(reference.data(), &index, sizeof index);
+                        parsed = nlohmann::json::binary(std::move(reference), SpilledDocument::Subtype);
+                    }
+                }
+                return true;
+            });
+        return doc;
+    }
+};
+
+// ============================================================================
+// SpillBuffer
+// ============================================================================
+//
+// Accumulates one inbound payload in memory until it grows past `threshold`
+// bytes, then moves it to a SpillFile and streams the rest there.
+// A threshold of 0 never spills.
+
+class SpillBuffer {
+    size_t threshold;
+    std::string directory;
+    std::string memory;
+    std::shared_ptr<SpillFile> file;
+
+public:
+    explicit SpillBuffer(size_t threshold = 0, std::string directory = {})
+        : threshold(threshold), directory(std::move(directory)) {}
+
+    void append(const char* data, size_t size) {
+        if (file) {
+            file->append(data, size);
+            return;
+        }
+        if (threshold > 0 && memory.size() + size > threshold) {
+            file = std::make_shared<SpillFile>(directory);
+            file->append(memory.data(), memory.size());
+            file->append(data, size);
+            std::string().swap(memory);
+            return;
+        }
+        memory.append(data, size);
+    }
+
+    size_t size() const {
+        return file ? file->size() : memory.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    Message take() {
+        Message m = file ? Message(std::move(file)) : Message(std::move(memory));
+        clear();
+        return m;
+    }
+
+    void clear() {
+        file.reset();
+        memory.clear();
+    }
+};
+
+} // namespace mcp
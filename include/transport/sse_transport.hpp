@@ -1,14 +1,20 @@
 #pragma once
 #include "../type/mcp_type.hpp"
 #include "transport.hpp"
+#include "compression.hpp"
+#include "http_result.hpp"
+#include "backoff.hpp"
+#include "../type/base64.hpp"
 #include <httplib.h>
 #include <thread>
 #include <atomic>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <regex>
-#include <sstream>
 #include <iostream>
 
 namespace mcp {
@@ -22,103 +28,320 @@ class SseTransport : public Transport {
     type::SseConfig config;
     std::string sessionId;
     std::string lastEventId;
+    std::atomic<WireEncoding> encoding{WireEncoding::Json};
     std::mutex sessionMutex;
     std::condition_variable connectionCV;
+    StatusHandler statusHandler;
+    // Set when an endpoint event arrives: whether the server kept the
+    // previous session, and so replays what was missed after Last-Event-ID
+    std::atomic<bool> established{false};
+    std::atomic<bool> resumed{false};
 
-    std::string sseBuffer;
+    // Liveness: any received byte, keepalive comments included, refreshes
+    // lastActivity. The watchdog drops a stream that stays silent past
+    // config.heartbeatTimeoutMs and pings one idle past config.pingIntervalMs.
+    std::thread watchdog;
+    std::mutex watchdogMutex;
+    std::condition_variable watchdogCV;
+    std::atomic<std::chrono::steady_clock::rep> lastActivity{0};
+    // Ids of our pings still unanswered, oldest first. They survive a
+    // reconnect, so a reply that arrives late is still recognised and
+    // swallowed instead of reaching the client as an unknown response.
+    std::mutex pingMutex;
+    std::deque<std::string> unansweredPings;
+    std::atomic<bool> pingsUnanswered{false};
+    std::atomic<unsigned> nextPing{0};
 
-    void parseSSEMessage(const std::string& rawData, const MessageHandler& onMessage) {
-        sseBuffer += rawData;
-        
-        size_t pos = 0;
-        while ((pos = sseBuffer.find("\n\n")) != std::string::npos) {
-            std::string event = sseBuffer.substr(0, pos);
-            sseBuffer.erase(0, pos + 2);
-            
-            if (!event.empty()) {
-                processSSEEvent(event, onMessage);
+    static constexpr std::string_view HeartbeatIdPrefix = "heartbeat-";
+    static constexpr size_t MaxPingReplyBytes = 256;
+    static constexpr size_t MaxUnansweredPings = 64;
+
+    // Incremental event-stream parser state. Chunks are consumed in place;
+    // `data:` values are streamed into eventData, which spills to disk past
+    // config.spillThresholdBytes, so a large event is never copied whole.
+    enum class LineState { Field, Value, Skip };
+    LineState lineState = LineState::Field;
+    std::string field;
+    std::string fieldValue;
+    bool lineStart = true;
+    bool valueStart = false;
+    bool pendingCR = false;
+    size_t dataLines = 0;
+    std::string eventType = "message";
+    std::string eventId;
+    SpillBuffer eventData;
+
+    static constexpr size_t MaxFieldLength = 64;
+
+    void resetParser() {
+        lineState = LineState::Field;
+        field.clear();
+        fieldValue.clear();
+        lineStart = true;
+        valueStart = false;
+        pendingCR = false;
+        dataLines = 0;
+        eventType = "message";
+        eventId.clear();
+        eventData.clear();
+    }
+
+    void touch() {
+        lastActivity.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    std::chrono::steady_clock::duration silence() const {
+        const std::chrono::steady_clock::time_point last(
+            std::chrono::steady_clock::duration(lastActivity.load(std::memory_order_relaxed)));
+        return std::chrono::steady_clock::now() - last;
+    }
+
+    void reportStatus(type::ConnectionStatus status) {
+        if (statusHandler) {
+            statusHandler(status);
+        }
+    }
+
+    void parseSSEMessage(const char* data, size_t len, const MessageHandler& onMessage) {
+        const char* end = data + len;
+        while (data < end) {
+            const char* nl = static_cast<const char*>(std::memchr(data, '\n', static_cast<size_t>(end - data)));
+            const char* stop = nl ? nl : end;
+            consumeLine(data, stop);
+            data = stop;
+            if (nl) {
+                finishLine(onMessage);
+                ++data;
             }
         }
     }
-    
-    void processSSEEvent(const std::string& eventBlock, const MessageHandler& onMessage) {
-        std::istringstream stream(eventBlock);
-        std::string line;
-    std::string eventType = "message";
-        std::string data;
-        std::string eventId;
-        
-        while (std::getline(stream, line)) {
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
+
+    // Consumes part of the current line; a line may span several chunks
+    void consumeLine(const char* p, const char* end) {
+        if (p == end) {
+            return;
+        }
+        if (lineState == LineState::Field) {
+            if (lineStart && *p == ':') {
+                lineState = LineState::Skip; // comment; counted as activity on arrival
             }
-            
-            if (line.empty() || line[0] == ':') {
-                continue;
+            lineStart = false;
+            while (lineState == LineState::Field && p < end) {
+                if (*p == ':') {
+                    lineState = LineState::Value;
+                    valueStart = true;
+                    if (field == "data" && dataLines > 0) {
+                        eventData.append("\n", 1);
+                    }
+                } else if (field.size() < MaxFieldLength) {
+                    field += *p;
+                } else {
+                    lineState = LineState::Skip;
+                }
+                ++p;
             }
-            
-            size_t colonPos = line.find(':');
-            if (colonPos == std::string::npos) {
-                continue;
+        }
+        if (lineState != LineState::Value || p == end) {
+            return;
+        }
+        if (valueStart) {
+            valueStart = false;
+            if (*p == ' ' && ++p == end) {
+                return;
             }
-            
-            std::string field = line.substr(0, colonPos);
-            std::string value = line.substr(colonPos + 1);
-            
-            if (!value.empty() && value[0] == ' ') {
-                value = value.substr(1);
+        }
+        if (field != "data") {
+            fieldValue.append(p, end);
+            return;
+        }
+        // Hold back a trailing CR until we know whether it ends the line
+        if (pendingCR) {
+            eventData.append("\r", 1);
+            pendingCR = false;
+        }
+        if (end[-1] == '\r') {
+            pendingCR = true;
+            --end;
+        }
+        eventData.append(p, static_cast<size_t>(end - p));
+    }
+
+    void finishLine(const MessageHandler& onMessage) {
+        if (lineStart) {
+            dispatchEvent(onMessage);
+        } else if (lineState == LineState::Field && field == "\r") {
+            dispatchEvent(onMessage);
+        } else if (lineState == LineState::Value) {
+            if (!fieldValue.empty() && fieldValue.back() == '\r') {
+                fieldValue.pop_back();
             }
-            
-            if (field == "event") {
-                eventType = value;
-            } else if (field == "data") {
-                if (!data.empty()) {
-                    data += "\n";
-                }
-                data += value;
+            if (field == "data") {
+                ++dataLines;
+            } else if (field == "event") {
+                eventType = fieldValue;
             } else if (field == "id") {
-                eventId = value;
+                eventId = fieldValue;
             }
         }
-        
+        lineState = LineState::Field;
+        field.clear();
+        fieldValue.clear();
+        lineStart = true;
+        valueStart = false;
+        pendingCR = false;
+    }
+
+    void dispatchEvent(const MessageHandler& onMessage) {
         if (!eventId.empty()) {
             lastEventId = eventId;
         }
-        
-        handleEvent(eventType, data, onMessage);
+        auto type = std::move(eventType);
+        auto message = eventData.take();
+        eventType = "message";
+        eventId.clear();
+        dataLines = 0;
+        handleEvent(type, std::move(message), onMessage);
     }
-    
-    void handleEvent(const std::string& eventType, const std::string& data, const MessageHandler& onMessage) {
-        if (data.empty()) {
+
+    void handleEvent(const std::string& eventType, Message&& message, const MessageHandler& onMessage) {
+        if (message.size() == 0) {
             return;
         }
         
         std::cout << "[SSE Transport] Event: " << eventType << std::endl;
         
         if (eventType == "endpoint") {
+            const std::string data(message.view());
             std::regex sessionRegex(R"(\?sessionId=([a-zA-Z0-9\-]+))");
             std::smatch match;
             if (std::regex_search(data, match, sessionRegex)) {
                 {
                     std::lock_guard<std::mutex> lock(sessionMutex);
+                    resumed.store(!sessionId.empty() && sessionId == match[1].str());
+                    established.store(true);
                     sessionId = match[1].str();
                     connected.store(true);
                     std::cout << "[SSE Transport] ✓ Captured sessionId: " << sessionId << std::endl;
                     std::cout << "[SSE Transport] Endpoint URL: " << data << std::endl;
                 }
                 connectionCV.notify_all();
+                touch();
+                reportStatus(type::ConnectionStatus::CONNECTED);
             }
         } else if (eventType == "message" || eventType.empty()) {
-            onMessage(data);
+            deliver(std::move(message), onMessage);
+        } else if (eventType == "message+cbor" || eventType == "message+msgpack") {
+            // Event streams are text: binary frames arrive base64-encoded
+            const auto frameEncoding = eventType == "message+cbor" ? WireEncoding::Cbor : WireEncoding::MsgPack;
+            const auto encoded = message.view();
+            std::string bytes(base64::Decoder::reserve(encoded.size()), '\0');
+            try {
+                bytes.resize(base64::decode(encoded, reinterpret_cast<uint8_t*>(bytes.data()), bytes.size()));
+            } catch (const std::exception& e) {
+                std::cout << "[SSE Transport] Invalid " << eventType << " frame: " << e.what() << std::endl;
+                return;
+            }
+            deliver(Message(std::move(bytes), frameEncoding), onMessage);
         } else {
             std::cout << "[SSE Transport] Unknown event type: " << eventType << std::endl;
-            std::cout << "[SSE Transport] Data: " << data << std::endl;
+            if (!message.spilled()) {
+                std::cout << "[SSE Transport] Data: " << message.view() << std::endl;
+            }
+        }
+    }
+
+    // Replies to our own pings only matter as traffic; only small messages
+    // are inspected, and only while a ping is unanswered
+    void deliver(Message&& message, const MessageHandler& onMessage) {
+        if (pingsUnanswered.load() && !message.spilled() && message.size() <= MaxPingReplyBytes &&
+            answersPing(message)) {
+            return;
+        }
+        onMessage(std::move(message));
+    }
+
+    bool answersPing(const Message& message) {
+        std::string id;
+        try {
+            const auto j = message.parse();
+            const auto it = j.find("id");
+            if (it == j.end() || !it->is_string()) {
+                return false;
+            }
+            id = it->get<std::string>();
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (id.compare(0, HeartbeatIdPrefix.size(), HeartbeatIdPrefix) != 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(pingMutex);
+        const auto it = std::find(unansweredPings.begin(), unansweredPings.end(), id);
+        if (it == unansweredPings.end()) {
+            return false;
+        }
+        unansweredPings.erase(it);
+        pingsUnanswered.store(!unansweredPings.empty());
+        return true;
+    }
+
+    void sendPing() {
+        const auto id = std::string(HeartbeatIdPrefix) + std::to_string(nextPing++);
+        const nlohmann::json ping = {{"jsonrpc", "2.0"}, {"id", id}, {"method", "ping"}};
+        {
+            std::lock_guard<std::mutex> lock(pingMutex);
+            unansweredPings.push_back(id);
+            if (unansweredPings.size() > MaxUnansweredPings) {
+                unansweredPings.pop_front();
+            }
+            pingsUnanswered.store(true);
+        }
+        std::cout << "[SSE Transport] Stream idle, sending " << id << std::endl;
+        try {
+            send(encode(ping, encoding.load()));
+        } catch (const TransportError& e) {
+            // Left to the heartbeat timeout
+            std::cout << "[SSE Transport] Ping not sent: " << e.what() << std::endl;
+        }
+    }
+
+    void watch() {
+        using namespace std::chrono;
+        const milliseconds timeout(std::max(config.heartbeatTimeoutMs, 0));
+        const milliseconds pingAfter(std::max(config.pingIntervalMs, 0));
+        milliseconds period(1000);
+        if (timeout.count() > 0) period = std::min(period, timeout / 4);
+        if (pingAfter.count() > 0) period = std::min(period, pingAfter / 4);
+        period = std::max(period, milliseconds(10));
+
+        steady_clock::time_point lastPing;
+        std::unique_lock<std::mutex> lock(watchdogMutex);
+        while (running.load()) {
+            watchdogCV.wait_for(lock, period, [this] { return !running.load(); });
+            if (!running.load() || !connected.load()) {
+                continue;
+            }
+            const auto silent = silence();
+            if (timeout.count() > 0 && silent >= timeout) {
+                std::cout << "[SSE Transport] No data for " << duration_cast<milliseconds>(silent).count()
+                          << "ms, dropping stream" << std::endl;
+                connected.store(false);
+                client->stop(); // unblocks the listener, which reconnects
+                continue;
+            }
+            const auto now = steady_clock::now();
+            if (pingAfter.count() > 0 && silent >= pingAfter && now - lastPing >= pingAfter) {
+                lastPing = now;
+                lock.unlock();
+                sendPing();
+                lock.lock();
+            }
         }
     }
 
 public:
     explicit SseTransport(const type::SseConfig& config)
-        : config(config) {}
+        : config(config), lastEventId(config.lastEventId), eventData(config.spillThresholdBytes, config.spillDirectory) {}
 
     ~SseTransport() override {
         stop();
@@ -149,7 +372,7 @@ public:
             std::cout << "[SSE Transport] Waiting for connection before sending..." << std::endl;
             if (!waitForConnection(10000)) {
                 std::cout << "[SSE Transport] ERROR: Connection timeout - cannot send message" << std::endl;
-                return;
+                throw TransportError("SSE connection timeout - cannot send message", 0, false);
             }
         }
         
@@ -169,17 +392,19 @@ public:
             endpoint += "?sessionId=" + currentSessionId;
         }
         
+        const std::string type(contentType(encoding.load()));
         httplib::Headers headers = {
-            {"Content-Type", "application/json"},
-            {"Accept", "application/json"}
+            {"Content-Type", type},
+            {"Accept", type}
         };
         
         for (const auto& [key, value] : config.headers) {
             headers.emplace(key, value);
         }
+        applyCompression(cli, headers, config.acceptEncodings, config.compressRequestBytes, message.size());
         
         std::cout << "[SSE Transport] POST to: " << config.url << endpoint << std::endl;
-        auto res = cli.Post(endpoint.c_str(), headers, message, "application/json");
+        auto res = cli.Post(endpoint.c_str(), headers, message, type.c_str());
         
         if (res) {
             std::cout << "[SSE Transport] POST response status: " << res->status << std::endl;
@@ -189,6 +414,7 @@ public:
         } else {
             std::cout << "[SSE Transport] POST failed - Error: " << httplib::to_string(res.error()) << std::endl;
         }
+        throwIfFailed(res, config.url + endpoint);
     }
 
     void start(MessageHandler onMessage) override {
@@ -198,18 +424,25 @@ public:
         }
         
         running = true;
+        client = std::make_shared<httplib::Client>(config.url);
+        touch();
+        if (config.heartbeatTimeoutMs > 0 || config.pingIntervalMs > 0) {
+            watchdog = std::thread([this]() { watch(); });
+        }
         listener = std::thread([this, onMessage]() {
-            client = std::make_shared<httplib::Client>(config.url);
-            
             client->set_connection_timeout(10, 0);
             // Augmenter le timeout de lecture pour SSE (pas de timeout pour les connexions persistantes)
             client->set_read_timeout(300, 0); // 5 minutes au lieu de 0.5 secondes
             
-            client->set_compress(false);
             client->set_keep_alive(true);
             
+            // Counts consecutive failures; reset once a session is established
             int attemptCount = 0;
             const int maxAttempts = config.maxRetries > 0 ? config.maxRetries : -1;
+            Backoff backoff(std::chrono::milliseconds(config.reconnectDelayMs),
+                            std::chrono::milliseconds(config.maxReconnectDelayMs),
+                            std::chrono::milliseconds(config.firstReconnectDelayMs));
+            reportStatus(type::ConnectionStatus::CONNECTING);
             
             while (running.load() && (maxAttempts == -1 || attemptCount < maxAttempts)) {
                 try {
@@ -231,23 +464,25 @@ public:
                     for (const auto& [key, value] : config.headers) {
                         headers.emplace(key, value);
                     }
+                    // Chunks reach the parser already inflated
+                    applyCompression(*client, headers, config.acceptEncodings, 0);
                     
-                    sseBuffer.clear();
+                    resetParser();
                     
                     auto res = client->Get(
                         config.sseEndpoint.c_str(),
                         headers,
                         [&](const char* data, size_t len) {
+                            touch();
                             if (!running.load()) {
                                 std::cout << "[SSE Transport] Stopping stream reading (user requested)" << std::endl;
                                 return false;
                             }
                             
-                            std::string chunk(data, len);
-                            if (!chunk.empty()) {
+                            if (len > 0) {
                                 // Debug: afficher les données brutes reçues
                                 std::cout << "[SSE Transport] Received chunk (" << len << " bytes)" << std::endl;
-                                parseSSEMessage(chunk, onMessage);
+                                parseSSEMessage(data, len, onMessage);
                             }
                             return true;
                         }
@@ -287,23 +522,33 @@ public:
                         std::cout << "[SSE Transport] Connection closed by server (normal)" << std::endl;
                     }
                     
-                    attemptCount++;
-                    
-                    if (running.load() && (maxAttempts == -1 || attemptCount < maxAttempts)) {
-                        int delay = std::min(config.reconnectDelayMs * (attemptCount > 1 ? attemptCount : 1), 30000);
-                        std::cout << "[SSE Transport] Reconnecting in " << delay << "ms (attempt " 
-                                  << (attemptCount + 1) << "/" << (maxAttempts == -1 ? "∞" : std::to_string(maxAttempts)) << ")" << std::endl;
-                        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-                    }
-                    
                 } catch (const std::exception& e) {
                     std::cout << "[SSE Transport] Exception: " << e.what() << std::endl;
                     if (!running.load()) {
                         break;
                     }
-                    attemptCount++;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(config.reconnectDelayMs));
+                    connected.store(false);
+                }
+                
+                // A stream that got as far as a session was a success
+                if (established.exchange(false)) {
+                    attemptCount = 0;
+                    backoff.reset();
                 }
+                attemptCount++;
+                if (!running.load() || (maxAttempts != -1 && attemptCount >= maxAttempts)) {
+                    if (running.load()) {
+                        reportStatus(type::ConnectionStatus::ERROR);
+                    }
+                    break;
+                }
+                reportStatus(type::ConnectionStatus::RECONNECTING);
+                
+                const auto delay = backoff.next();
+                std::cout << "[SSE Transport] Reconnecting in " << delay.count() << "ms (attempt "
+                          << (attemptCount + 1) << "/" << (maxAttempts == -1 ? "∞" : std::to_string(maxAttempts)) << ")" << std::endl;
+                std::unique_lock<std::mutex> lock(sessionMutex);
+                connectionCV.wait_for(lock, delay, [this] { return !running.load(); });
             }
             
             std::cout << "[SSE Transport] Listener thread exiting" << std::endl;
@@ -320,6 +565,10 @@ public:
         connected.store(false);
         
         connectionCV.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(watchdogMutex);
+            watchdogCV.notify_all();
+        }
         
         if (client) {
             client->stop();
@@ -328,10 +577,27 @@ public:
         if (listener.joinable()) {
             listener.join();
         }
+        if (watchdog.joinable()) {
+            watchdog.join();
+        }
+        reportStatus(type::ConnectionStatus::DISCONNECTED);
         
         std::cout << "[SSE Transport] Stopped" << std::endl;
     }
 
+    void onStatus(StatusHandler handler) override {
+        statusHandler = std::move(handler);
+    }
+
+    bool resumedSession() const override {
+        return resumed.load();
+    }
+
+    bool setEncoding(WireEncoding e) override {
+        encoding.store(e);
+        return true;
+    }
+
     Transport::Config getConfig() const override{
         return config;
     }
@@ -1,23 +1,62 @@
 #pragma once
 #include <string>
+#include <chrono>
 #include <functional>
+#include <stdexcept>
 #include <variant>
 #include "../type/mcp_type.hpp"
+#include "message.hpp"
 
 namespace mcp {
 
+// Thrown by Transport::send() when a message was not accepted. `status` is
+// the HTTP status of a refused POST, 0 if no response came back.
+// `delivered` is false only when the message certainly never reached the
+// server (no connection could be made), so sending it again cannot run it
+// twice. `retryAfter` is the server's Retry-After, if it sent one.
+class TransportError : public std::runtime_error {
+public:
+    int status;
+    bool delivered;
+    std::chrono::milliseconds retryAfter;
+
+    TransportError(const std::string& message, int status, bool delivered,
+                   std::chrono::milliseconds retryAfter = std::chrono::milliseconds(0))
+        : std::runtime_error(message), status(status), delivered(delivered), retryAfter(retryAfter) {}
+};
+
 class Transport {
 public:
-    using MessageHandler = std::function<void(const std::string&)>;
+    using MessageHandler = std::function<void(Message&&)>;
+    using StatusHandler = std::function<void(type::ConnectionStatus)>;
 
     using Config = std::variant<type::HttpConfig, type::SseConfig, type::WebSocketConfig>;
 
     virtual ~Transport() = default;
 
+    // Throws TransportError if the message could not be handed over
     virtual void send(const std::string& message) = 0;
     virtual void start(MessageHandler onMessage) = 0;
     virtual void stop() = 0;
 
+    // Reports connection changes, e.g. RECONNECTING when a stream is lost.
+    // Set before start(); transports without a persistent connection never
+    // call it.
+    virtual void onStatus(StatusHandler) {}
+
+    // Whether the last CONNECTED continued the previous session, so
+    // responses to requests sent before the drop will still arrive
+    virtual bool resumedSession() const {
+        return false;
+    }
+
+    // Switches the encoding of messages sent from now on and of the messages
+    // expected back (see encoding.hpp). Returns false if the transport
+    // cannot carry it; JSON is always supported.
+    virtual bool setEncoding(WireEncoding encoding) {
+        return encoding == WireEncoding::Json;
+    }
+
     // Retourne le type/identifiant de configuration du transport
     virtual Config getConfig() const = 0;
 };
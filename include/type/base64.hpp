@@ -0,0 +1,281 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MCP_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+namespace mcp {
+namespace base64 {
+// ============================================================================
+// Base64 decoding
+// ============================================================================
+//
+// Streaming decoder for the base64 payloads of image, audio and blob
+// content. Bulk input goes through an AVX2 or SSE4.1 kernel (picked at run
+// time) that turns 32/16 characters into 24/12 bytes per step; the scalar
+// path handles chunk boundaries, padding, whitespace and invalid input.
+
+inline constexpr size_t maxDecodedSize(size_t encodedLength) {
+    return (encodedLength + 3) / 4 * 3;
+}
+
+// Exact decoded size of a complete payload without embedded whitespace
+inline size_t decodedSize(std::string_view encoded) {
+    size_t n = encoded.size();
+    while (n > 0 && encoded[n - 1] == '=') --n;
+    return n / 4 * 3 + (n % 4 == 0 ? 0 : n % 4 - 1);
+}
+
+namespace detail {
+
+constexpr uint8_t Invalid = 0xFF;
+constexpr uint8_t Skip = 0xFE;
+
+constexpr std::array<uint8_t, 256> makeTable() {
+    std::array<uint8_t, 256> t{};
+    for (auto& v : t) v = Invalid;
+    constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (uint8_t i = 0; i < 64; ++i) {
+        t[static_cast<uint8_t>(alphabet[i])] = i;
+    }
+    t[static_cast<uint8_t>(' ')] = Skip;
+    t[static_cast<uint8_t>('\t')] = Skip;
+    t[static_cast<uint8_t>('\r')] = Skip;
+    t[static_cast<uint8_t>('\n')] = Skip;
+    return t;
+}
+
+constexpr std::array<uint8_t, 256> table = makeTable();
+
+#ifdef MCP_BASE64_X86
+
+// Muła's nibble-lookup validation and translation, then a multiply-add
+// pack of four 6-bit values into three bytes. Each call stops at the first
+// block containing a non-alphabet character and returns the input consumed.
+// Every store writes a full register, so `outCapacity` must exceed the
+// decoded bytes by the register slack.
+
+__attribute__((target("avx2")))
+inline size_t decodeAvx2(const char* in, size_t len, uint8_t* out, size_t outCapacity, size_t& written) {
+    const __m256i lutLo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2f);
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+    size_t consumed = 0;
+    written = 0;
+    while (len - consumed >= 32 && outCapacity - written >= 32) {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + consumed));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+        const __m256i loNibbles = _mm256_and_si256(str, mask2F);
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm256_testz_si256(lo, hi)) {
+            break;
+        }
+        const __m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        str = _mm256_add_epi8(str, roll);
+        str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+        str = _mm256_shuffle_epi8(str, pack);
+        str = _mm256_permutevar8x32_epi32(str, lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), str);
+        consumed += 32;
+        written += 24;
+    }
+    return consumed;
+}
+
+__attribute__((target("sse4.1")))
+inline size_t decodeSse41(const char* in, size_t len, uint8_t* out, size_t outCapacity, size_t& written) {
+    const __m128i lutLo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t consumed = 0;
+    written = 0;
+    while (len - consumed >= 16 && outCapacity - written >= 16) {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + consumed));
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+        const __m128i loNibbles = _mm_and_si128(str, mask2F);
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+        if (!_mm_testz_si128(lo, hi)) {
+            break;
+        }
+        const __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+        str = _mm_add_epi8(str, roll);
+        str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+        str = _mm_shuffle_epi8(str, pack);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), str);
+        consumed += 16;
+        written += 12;
+    }
+    return consumed;
+}
+
+#endif
+
+enum class Kernel { Scalar, Sse41, Avx2 };
+
+inline Kernel bestKernel() {
+#ifdef MCP_BASE64_X86
+    static const Kernel kernel = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Kernel::Avx2;
+        if (__builtin_cpu_supports("sse4.1")) return Kernel::Sse41;
+        return Kernel::Scalar;
+    }();
+    return kernel;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+} // namespace detail
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+class Decoder {
+    uint32_t quantum = 0;
+    int quantumLength = 0;
+    int padding = 0;
+    detail::Kernel kernel;
+
+    [[noreturn]] static void fail() {
+        throw std::invalid_argument("Invalid base64 input");
+    }
+
+    size_t bulk(const char* in, size_t len, uint8_t* out, size_t outCapacity, size_t& written) {
+        written = 0;
+#ifdef MCP_BASE64_X86
+        switch (kernel) {
+            case detail::Kernel::Avx2: return detail::decodeAvx2(in, len, out, outCapacity, written);
+            case detail::Kernel::Sse41: return detail::decodeSse41(in, len, out, outCapacity, written);
+            default: break;
+        }
+#else
+        (void)in; (void)len; (void)out; (void)outCapacity;
+#endif
+        return 0;
+    }
+
+public:
+    explicit Decoder(detail::Kernel k = detail::bestKernel())
+        : kernel(k) {}
+
+    // Decodes the next chunk of input, which may split a 4-character group.
+    // `capacity` must be at least maxDecodedSize(len) + 3 (see Decoder::reserve).
+    // Returns the number of bytes written to `out`.
+    size_t update(const char* in, size_t len, uint8_t* out, size_t capacity) {
+        if (capacity < reserve(len)) {
+            throw std::length_error("base64::Decoder: output buffer too small");
+        }
+        size_t pos = 0;
+        size_t written = 0;
+        size_t scalarRun = 0;
+        while (pos < len) {
+            if (quantumLength == 0 && padding == 0 && scalarRun == 0) {
+                size_t produced = 0;
+                pos += bulk(in + pos, len - pos, out + written, capacity - written, produced);
+                written += produced;
+                // After a failed block, decode a block's worth scalar before retrying
+                scalarRun = 32;
+                if (pos == len) break;
+            }
+            if (scalarRun > 0) --scalarRun;
+
+            const auto c = static_cast<uint8_t>(in[pos++]);
+            const uint8_t v = detail::table[c];
+            if (v == detail::Skip) {
+                continue;
+            }
+            if (c == '=') {
+                if (quantumLength < 2 || ++padding + quantumLength > 4) fail();
+                continue;
+            }
+            if (v == detail::Invalid || padding > 0) {
+                fail();
+            }
+            quantum = (quantum << 6) | v;
+            if (++quantumLength == 4) {
+                out[written++] = static_cast<uint8_t>(quantum >> 16);
+                out[written++] = static_cast<uint8_t>(quantum >> 8);
+                out[written++] = static_cast<uint8_t>(quantum);
+                quantum = 0;
+                quantumLength = 0;
+            }
+        }
+        if (padding > 0 && quantumLength + padding == 4) {
+            written += flushPartial(out + written);
+        }
+        return written;
+    }
+
+    // Ends the stream; decodes a trailing unpadded group. Returns bytes written (0-2).
+    size_t finish(uint8_t* out) {
+        if (padding > 0) {
+            return 0;
+        }
+        return flushPartial(out);
+    }
+
+    static constexpr size_t reserve(size_t len) {
+        return maxDecodedSize(len) + 3;
+    }
+
+private:
+    size_t flushPartial(uint8_t* out) {
+        size_t written = 0;
+        if (quantumLength == 1) {
+            fail();
+        } else if (quantumLength == 2) {
+            out[written++] = static_cast<uint8_t>(quantum >> 4);
+        } else if (quantumLength == 3) {
+            out[written++] = static_cast<uint8_t>(quantum >> 10);
+            out[written++] = static_cast<uint8_t>(quantum >> 2);
+        }
+        quantum = 0;
+        quantumLength = 0;
+        // Keep `padding` set: nothing may follow it
+        if (padding == 0 && written > 0) padding = 4;
+        return written;
+    }
+};
+
+// Decodes a whole payload into `out`; returns the number of bytes written.
+// `capacity` must be at least Decoder::reserve(encoded.size()).
+inline size_t decode(std::string_view encoded, uint8_t* out, size_t capacity) {
+    Decoder decoder;
+    size_t written = decoder.update(encoded.data(), encoded.size(), out, capacity);
+    return written + decoder.finish(out + written);
+}
+
+} // namespace base64
+} // namespace mcp
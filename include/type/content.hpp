@@ -0,0 +1,80 @@
+#pragma once
+#include "schema.hpp"
+#include "base64.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Binary Content Accessors
+// ============================================================================
+//
+// Decode the base64 payload of image, audio and blob content straight into a
+// caller-provided buffer, a sink or a file. Sinks receive the decoded bytes
+// in chunks, so the decoded payload is never held in memory as a whole.
+// For a payload left in a spilled message's file, pass
+// SpilledDocument::payload() of the field to decodeBase64To() or
+// decodeBase64ToFile().
+
+inline std::string_view base64Payload(const ImageContent& c) { return c.data; }
+inline std::string_view base64Payload(const AudioContent& c) { return c.data; }
+inline std::string_view base64Payload(const BlobResourceContents& c) { return c.blob; }
+
+template <class Content>
+inline size_t decodedSize(const Content& content) {
+    return base64::decodedSize(base64Payload(content));
+}
+
+// `capacity` must be at least base64::Decoder::reserve(payload length);
+// returns the number of bytes written
+template <class Content>
+inline size_t decodeInto(const Content& content, uint8_t* out, size_t capacity) {
+    return base64::decode(base64Payload(content), out, capacity);
+}
+
+// Sink: callable as sink(const uint8_t* data, size_t size)
+template <class Sink>
+inline void decodeBase64To(std::string_view encoded, Sink&& sink, size_t chunkSize = 64 * 1024) {
+    // Keep chunks on 4-character boundaries so each one decodes in bulk
+    chunkSize = std::max<size_t>(chunkSize / 4 * 4, 4);
+    std::vector<uint8_t> buffer(base64::Decoder::reserve(chunkSize));
+    base64::Decoder decoder;
+    for (size_t pos = 0; pos < encoded.size(); pos += chunkSize) {
+        const size_t len = std::min(chunkSize, encoded.size() - pos);
+        const size_t n = decoder.update(encoded.data() + pos, len, buffer.data(), buffer.size());
+        if (n > 0) sink(buffer.data(), n);
+    }
+    const size_t n = decoder.finish(buffer.data());
+    if (n > 0) sink(buffer.data(), n);
+}
+
+template <class Content, class Sink>
+inline void decodeTo(const Content& content, Sink&& sink, size_t chunkSize = 64 * 1024) {
+    decodeBase64To(base64Payload(content), std::forward<Sink>(sink), chunkSize);
+}
+
+inline void decodeBase64ToFile(std::string_view encoded, const std::string& path) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+    decodeBase64To(encoded, [&](const uint8_t* data, size_t size) {
+        if (std::fwrite(data, 1, size, file.get()) != size) {
+            throw std::runtime_error("Write failed: " + path);
+        }
+    });
+}
+
+template <class Content>
+inline void decodeToFile(const Content& content, const std::string& path) {
+    decodeBase64ToFile(base64Payload(content), path);
+}
+
+} // namespace type
+} // namespace mcp
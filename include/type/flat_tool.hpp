@@ -0,0 +1,283 @@
+#pragma once
+#include "schema.hpp"
+#include "schema_serialization.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Flat Tool Catalog
+// ============================================================================
+//
+// Compact, read-only layout for a cached tool list (see
+// McpServerConfig::cacheToolList). All strings live once in a shared pool and
+// are referenced by 8-byte StrRefs (an absent optional is a sentinel, not a
+// 40-byte boost::optional<std::string>). Tools keep the server's order in
+// one contiguous array, with a name index for binary-search lookups; their
+// properties are sorted by name in another. Property schemas, outputSchema
+// and _meta are kept as serialized JSON and only parsed when a Tool is
+// rebuilt.
+
+struct StrRef {
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    uint32_t offset = 0;
+    uint32_t length = None;
+
+    bool has_value() const { return length != None; }
+};
+
+enum class SchemaType : uint8_t { Any, String, Number, Integer, Boolean, Object, Array, Null };
+
+inline SchemaType schemaTypeOf(const nlohmann::json& schema) {
+    auto it = schema.find("type");
+    if (it == schema.end() || !it->is_string()) return SchemaType::Any;
+    const auto& t = it->get_ref<const std::string&>();
+    if (t == "string") return SchemaType::String;
+    if (t == "number") return SchemaType::Number;
+    if (t == "integer") return SchemaType::Integer;
+    if (t == "boolean") return SchemaType::Boolean;
+    if (t == "object") return SchemaType::Object;
+    if (t == "array") return SchemaType::Array;
+    if (t == "null") return SchemaType::Null;
+    return SchemaType::Any;
+}
+
+struct FlatProperty {
+    StrRef name;
+    StrRef description;
+    StrRef schema;  // serialized property schema
+    SchemaType type = SchemaType::Any;
+};
+
+// Tri-state ToolAnnotations hints, two bits each
+enum class Hint : uint8_t { ReadOnly = 0, Destructive = 2, Idempotent = 4, OpenWorld = 6 };
+
+struct FlatTool {
+    enum Flags : uint8_t { HasAnnotations = 1, HasOutputSchema = 2, HasMeta = 4, HasProperties = 8, HasRequired = 16 };
+
+    StrRef name;
+    StrRef title;
+    StrRef description;
+    StrRef schemaType;
+    StrRef outputSchema;     // serialized OutputSchema
+    StrRef annotationTitle;
+    StrRef meta;             // serialized _meta
+    uint32_t firstProperty = 0;
+    uint32_t firstRequired = 0;
+    uint16_t propertyCount = 0;
+    uint16_t requiredCount = 0;
+    uint8_t hints = 0;
+    uint8_t flags = 0;
+
+    // Unset hints yield boost::none
+    boost::optional<bool> hint(Hint h) const {
+        const uint8_t v = (hints >> static_cast<uint8_t>(h)) & 3;
+        if (v == 0) return boost::none;
+        return v == 2;
+    }
+};
+
+class ToolCatalog {
+    std::string pool;
+    std::vector<FlatTool> tools;    // listing order
+    std::vector<uint32_t> byName;   // indexes into tools, sorted by name
+    std::vector<FlatProperty> properties;
+    std::vector<StrRef> required;
+
+    // Deduplicates while pages are appended; dropped by finish()
+    std::unordered_map<std::string, StrRef> interned;
+
+    StrRef intern(std::string_view s) {
+        auto [it, inserted] = interned.try_emplace(std::string(s));
+        if (inserted) {
+            if (pool.size() + s.size() > StrRef::None - 1) {
+                throw std::length_error("ToolCatalog string pool exceeds 4 GiB");
+            }
+            it->second = {static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(s.size())};
+            pool.append(s);
+        }
+        return it->second;
+    }
+
+    StrRef internOptional(const boost::optional<std::string>& s) {
+        return s ? intern(std::string_view(*s)) : StrRef{};
+    }
+
+    static void setHint(uint8_t& hints, Hint h, const boost::optional<bool>& value) {
+        if (value) hints |= static_cast<uint8_t>((*value ? 2 : 1) << static_cast<uint8_t>(h));
+    }
+
+    boost::optional<std::string> optional(StrRef r) const {
+        if (!r.has_value()) return boost::none;
+        return std::string(str(r));
+    }
+
+public:
+    ToolCatalog() = default;
+
+    explicit ToolCatalog(const std::vector<Tool>& source) {
+        append(source);
+        finish();
+    }
+
+    // Adds a page of a listing; call finish() after the last one
+    void append(const std::vector<Tool>& page) {
+        tools.reserve(tools.size() + page.size());
+        for (const Tool& t : page) {
+            if ((t.inputSchema.properties && t.inputSchema.properties->size() > UINT16_MAX) ||
+                (t.inputSchema.required && t.inputSchema.required->size() > UINT16_MAX)) {
+                throw std::length_error("Tool " + t.name + " has too many properties");
+            }
+            FlatTool f;
+            f.name = intern(t.name);
+            f.title = internOptional(t.title);
+            f.description = internOptional(t.description);
+            f.schemaType = intern(t.inputSchema.type);
+
+            if (const auto& props = t.inputSchema.properties) {
+                f.flags |= FlatTool::HasProperties;
+                f.firstProperty = static_cast<uint32_t>(properties.size());
+                f.propertyCount = static_cast<uint16_t>(props->size());
+                // std::map iterates in name order already
+                for (const auto& [name, schema] : *props) {
+                    FlatProperty p;
+                    p.name = intern(name);
+                    auto desc = schema.is_object() ? schema.find("description") : schema.end();
+                    if (desc != schema.end() && desc->is_string()) {
+                        p.description = intern(desc->get_ref<const std::string&>());
+                    }
+                    p.schema = intern(schema.dump());
+                    p.type = schema.is_object() ? schemaTypeOf(schema) : SchemaType::Any;
+                    properties.push_back(p);
+                }
+            }
+            if (const auto& req = t.inputSchema.required) {
+                f.flags |= FlatTool::HasRequired;
+                f.firstRequired = static_cast<uint32_t>(required.size());
+                f.requiredCount = static_cast<uint16_t>(req->size());
+                for (const auto& r : *req) required.push_back(intern(r));
+            }
+            if (t.outputSchema) {
+                f.flags |= FlatTool::HasOutputSchema;
+                f.outputSchema = intern(nlohmann::json(*t.outputSchema).dump());
+            }
+            if (const auto& a = t.annotations) {
+                f.flags |= FlatTool::HasAnnotations;
+                f.annotationTitle = internOptional(a->title);
+                setHint(f.hints, Hint::ReadOnly, a->readOnlyHint);
+                setHint(f.hints, Hint::Destructive, a->destructiveHint);
+                setHint(f.hints, Hint::Idempotent, a->idempotentHint);
+                setHint(f.hints, Hint::OpenWorld, a->openWorldHint);
+            }
+            if (t._meta) {
+                f.flags |= FlatTool::HasMeta;
+                f.meta = intern(nlohmann::json(*t._meta).dump());
+            }
+            tools.push_back(f);
+        }
+    }
+
+    // Builds the name index and releases the build-time memory. A name
+    // listed twice finds its first entry.
+    void finish() {
+        byName.resize(tools.size());
+        for (uint32_t i = 0; i < byName.size(); ++i) byName[i] = i;
+        std::stable_sort(byName.begin(), byName.end(),
+                         [this](uint32_t a, uint32_t b) { return str(tools[a].name) < str(tools[b].name); });
+        std::unordered_map<std::string, StrRef>().swap(interned);
+        pool.shrink_to_fit();
+        tools.shrink_to_fit();
+        properties.shrink_to_fit();
+        required.shrink_to_fit();
+    }
+
+    size_t size() const { return tools.size(); }
+    bool empty() const { return tools.empty(); }
+
+    const FlatTool& operator[](size_t i) const { return tools[i]; }
+    std::vector<FlatTool>::const_iterator begin() const { return tools.begin(); }
+    std::vector<FlatTool>::const_iterator end() const { return tools.end(); }
+
+    std::string_view str(StrRef r) const {
+        return r.has_value() ? std::string_view(pool.data() + r.offset, r.length) : std::string_view();
+    }
+
+    const FlatProperty* propertiesOf(const FlatTool& t) const { return properties.data() + t.firstProperty; }
+    const StrRef* requiredOf(const FlatTool& t) const { return required.data() + t.firstRequired; }
+
+    const FlatTool* find(std::string_view name) const {
+        auto it = std::lower_bound(byName.begin(), byName.end(), name,
+                                   [this](uint32_t i, std::string_view n) { return str(tools[i].name) < n; });
+        return it != byName.end() && str(tools[*it].name) == name ? &tools[*it] : nullptr;
+    }
+
+    const FlatProperty* findProperty(const FlatTool& t, std::string_view name) const {
+        const FlatProperty* first = propertiesOf(t);
+        const FlatProperty* last = first + t.propertyCount;
+        auto it = std::lower_bound(first, last, name,
+                                   [this](const FlatProperty& p, std::string_view n) { return str(p.name) < n; });
+        return it != last && str(it->name) == name ? it : nullptr;
+    }
+
+    // Approximate heap footprint, for cache accounting
+    size_t memoryBytes() const {
+        return pool.capacity() + tools.capacity() * sizeof(FlatTool) + byName.capacity() * sizeof(uint32_t) +
+               properties.capacity() * sizeof(FlatProperty) + required.capacity() * sizeof(StrRef);
+    }
+
+    Tool toTool(const FlatTool& f) const {
+        Tool t;
+        t.name = std::string(str(f.name));
+        t.title = optional(f.title);
+        t.description = optional(f.description);
+        t.inputSchema.type = std::string(str(f.schemaType));
+        if (f.flags & FlatTool::HasProperties) {
+            t.inputSchema.properties.emplace();
+            auto& props = *t.inputSchema.properties;
+            const FlatProperty* p = propertiesOf(f);
+            for (uint16_t i = 0; i < f.propertyCount; ++i) {
+                props.emplace_hint(props.end(), std::string(str(p[i].name)), nlohmann::json::parse(str(p[i].schema)));
+            }
+        }
+        if (f.flags & FlatTool::HasRequired) {
+            t.inputSchema.required.emplace();
+            auto& req = *t.inputSchema.required;
+            const StrRef* r = requiredOf(f);
+            for (uint16_t i = 0; i < f.requiredCount; ++i) req.emplace_back(str(r[i]));
+        }
+        if (f.flags & FlatTool::HasOutputSchema) {
+            t.outputSchema = nlohmann::json::parse(str(f.outputSchema)).get<OutputSchema>();
+        }
+        if (f.flags & FlatTool::HasAnnotations) {
+            t.annotations.emplace();
+            auto& a = *t.annotations;
+            a.title = optional(f.annotationTitle);
+            a.readOnlyHint = f.hint(Hint::ReadOnly);
+            a.destructiveHint = f.hint(Hint::Destructive);
+            a.idempotentHint = f.hint(Hint::Idempotent);
+            a.openWorldHint = f.hint(Hint::OpenWorld);
+        }
+        if (f.flags & FlatTool::HasMeta) {
+            t._meta = nlohmann::json::parse(str(f.meta)).get<std::map<std::string, nlohmann::json>>();
+        }
+        return t;
+    }
+
+    std::vector<Tool> toTools() const {
+        std::vector<Tool> out;
+        out.reserve(tools.size());
+        for (const auto& f : tools) out.push_back(toTool(f));
+        return out;
+    }
+};
+
+} // namespace type
+} // namespace mcp
@@ -10,6 +10,7 @@
 #include <chrono>
 #include <optional>
 #include <nlohmann/json.hpp>
+#include "symbol.hpp"
 
 namespace mcp {
 // Forward declaration
@@ -22,6 +23,11 @@ struct HttpConfig {
     std::map<std::string, std::string> headers;
     int timeoutMs = 30000;
     bool verifySSL = true;
+    // Content codings to offer for responses, most preferred first ("zstd",
+    // "br", "gzip", "deflate"); empty requests identity
+    std::vector<std::string> acceptEncodings;
+    // Request bodies at least this large are sent gzip-compressed; 0 disables
+    size_t compressRequestBytes = 0;
 };
 
 // JSON (de)serialization helpers for HttpConfig
@@ -30,7 +36,9 @@ inline void to_json(nlohmann::json &j, const HttpConfig &c) {
         {"baseUrl", c.baseUrl},
         {"headers", c.headers},
         {"timeoutMs", c.timeoutMs},
-        {"verifySSL", c.verifySSL}
+        {"verifySSL", c.verifySSL},
+        {"acceptEncodings", c.acceptEncodings},
+        {"compressRequestBytes", c.compressRequestBytes}
     };
 }
 inline void from_json(const nlohmann::json &j, HttpConfig &c) {
@@ -38,6 +46,8 @@ inline void from_json(const nlohmann::json &j, HttpConfig &c) {
     c.headers = j.value("headers", std::map<std::string, std::string>{});
     c.timeoutMs = j.value("timeoutMs", 30000);
     c.verifySSL = j.value("verifySSL", true);
+    c.acceptEncodings = j.value("acceptEncodings", std::vector<std::string>{});
+    c.compressRequestBytes = j.value("compressRequestBytes", size_t{0});
 }
 
 struct WebSocketConfig {
@@ -69,9 +79,33 @@ struct SseConfig {
     std::map<std::string, std::string> headers;
     int timeoutMs = 30000;
     bool verifySSL = true;
+    // Reconnects back off with decorrelated jitter (see backoff.hpp): the
+    // first within firstReconnectDelayMs, later ones between
+    // reconnectDelayMs and maxReconnectDelayMs
     int reconnectDelayMs = 3000;
+    int firstReconnectDelayMs = 100;
+    int maxReconnectDelayMs = 30000;
+    // Consecutive failed connection attempts before giving up; -1 retries forever
     int maxRetries = -1;
     std::string lastEventId;
+    // Event payloads larger than this are streamed to a temporary file in
+    // spillDirectory (system temp dir if empty) and memory-mapped; 0, the
+    // default, disables. The client still parses a spilled response whole,
+    // so this bounds the receive buffer, not the parsed result.
+    size_t spillThresholdBytes = 0;
+    std::string spillDirectory;
+    // Content codings to offer for the event stream and POST responses, most
+    // preferred first ("zstd", "br", "gzip", "deflate"); empty requests identity
+    std::vector<std::string> acceptEncodings;
+    // Request bodies at least this large are sent gzip-compressed; 0 disables
+    size_t compressRequestBytes = 0;
+    // The stream is declared dead, and reconnected, after this long without
+    // any bytes (events or ':' keepalive comments); 0 relies on the read
+    // timeout alone
+    int heartbeatTimeoutMs = 0;
+    // After this long without bytes a ping request is sent, so an idle but
+    // healthy server produces traffic; 0 disables
+    int pingIntervalMs = 0;
 };
 
 inline void to_json(nlohmann::json &j, const SseConfig &c) {
@@ -83,8 +117,16 @@ inline void to_json(nlohmann::json &j, const SseConfig &c) {
         {"timeoutMs", c.timeoutMs},
         {"verifySSL", c.verifySSL},
         {"reconnectDelayMs", c.reconnectDelayMs},
+        {"firstReconnectDelayMs", c.firstReconnectDelayMs},
+        {"maxReconnectDelayMs", c.maxReconnectDelayMs},
         {"maxRetries", c.maxRetries},
-        {"lastEventId", c.lastEventId}
+        {"lastEventId", c.lastEventId},
+        {"spillThresholdBytes", c.spillThresholdBytes},
+        {"spillDirectory", c.spillDirectory},
+        {"acceptEncodings", c.acceptEncodings},
+        {"compressRequestBytes", c.compressRequestBytes},
+        {"heartbeatTimeoutMs", c.heartbeatTimeoutMs},
+        {"pingIntervalMs", c.pingIntervalMs}
     };
 }
 inline void from_json(const nlohmann::json &j, SseConfig &c) {
@@ -95,8 +137,16 @@ inline void from_json(const nlohmann::json &j, SseConfig &c) {
     c.timeoutMs = j.value("timeoutMs", 30000);
     c.verifySSL = j.value("verifySSL", true);
     c.reconnectDelayMs = j.value("reconnectDelayMs", 3000);
+    c.firstReconnectDelayMs = j.value("firstReconnectDelayMs", 100);
+    c.maxReconnectDelayMs = j.value("maxReconnectDelayMs", 30000);
     c.maxRetries = j.value("maxRetries", -1);
     c.lastEventId = j.value("lastEventId", "");
+    c.spillThresholdBytes = j.value("spillThresholdBytes", size_t{0});
+    c.spillDirectory = j.value("spillDirectory", "");
+    c.acceptEncodings = j.value("acceptEncodings", std::vector<std::string>{});
+    c.compressRequestBytes = j.value("compressRequestBytes", size_t{0});
+    c.heartbeatTimeoutMs = j.value("heartbeatTimeoutMs", 0);
+    c.pingIntervalMs = j.value("pingIntervalMs", 0);
 }
 
 enum class ConnectionStatus {
@@ -117,7 +167,7 @@ NLOHMANN_JSON_SERIALIZE_ENUM(ConnectionStatus, {
 
 struct McpMessage {
     std::string id;
-    std::string method;
+    Symbol method;
     std::map<std::string, std::string> params;
     std::string result;
     std::string error;
@@ -181,22 +231,102 @@ inline void from_json(const nlohmann::json &j, McpTransportConfig &mtc) {
     }
 }
 
+// Token bucket (see rate_limiter.hpp): perSecond requests per second in
+// bursts of up to `burst`; perSecond 0 means no limit
+struct RateLimit {
+    double perSecond = 0;
+    double burst = 1;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(RateLimit, perSecond, burst)
+};
+
 struct McpServerConfig {
     std::string name;
     std::string description;
     bool autoReconnect = true;
     int maxRetries = 3;
     int retryDelayMs = 1000;
+    // How long mcp::call() waits for a response
+    int requestTimeoutMs = 30000;
+    // Server-initiated requests (sampling, roots, elicitation) handled at once
+    int maxConcurrentHandlers = 4;
+    // Further requests waiting for a handler slot before being rejected
+    int maxQueuedHandlers = 64;
+    // Fail calls fast while the server is unhealthy (see circuit_breaker.hpp):
+    // the circuit opens when at least breakerMinCalls calls in the last
+    // breakerWindowMs fail, or take breakerSlowCallMs or longer, at
+    // breakerFailureRate, and is probed with ping after breakerOpenMs
+    bool circuitBreaker = false;
+    int breakerWindowMs = 10000;
+    int breakerMinCalls = 20;
+    double breakerFailureRate = 0.5;
+    int breakerSlowCallMs = 0;
+    int breakerOpenMs = 5000;
+    // Adaptive cap on requests in flight (see concurrency_limiter.hpp);
+    // concurrencyAlgorithm is "gradient", "aimd" or "fixed" (the cap stays
+    // at initialConcurrency). Requests over the limit wait in a queue of up
+    // to maxQueuedRequests, with freed slots shared between the Low, Normal
+    // and High priority lanes by priorityWeights.
+    bool adaptiveConcurrency = false;
+    std::string concurrencyAlgorithm = "gradient";
+    int initialConcurrency = 20;
+    int minConcurrency = 1;
+    int maxConcurrency = 200;
+    int maxQueuedRequests = 100;
+    std::vector<int> priorityWeights = {1, 4, 16};
+    // Request rate limits for the whole server and per tool name. A call
+    // over its limit waits up to rateLimitWaitMs for a token, then fails
+    // with RateLimited without being sent.
+    RateLimit rateLimit;
+    std::map<std::string, RateLimit> toolRateLimits;
+    int rateLimitWaitMs = 0;
+    // Deadlines (see deadline.hpp). With propagateDeadlines, each request
+    // carries the time its caller has left, less deadlineMarginMs, in
+    // params._meta. A call with less than minDeadlineBudgetMs left fails
+    // with DeadlineExceeded without being sent.
+    bool propagateDeadlines = false;
+    int deadlineMarginMs = 0;
+    int minDeadlineBudgetMs = 0;
+    // Retries of failed call()/callTool() (see retry_policy.hpp), for
+    // idempotent requests or ones that never reached the server, up to
+    // maxCallAttempts in all. Retries are capped at retryBudgetRatio of
+    // calls, with retryBudgetReserve to start with.
+    bool retryFailedCalls = false;
+    int maxCallAttempts = 3;
+    int retryBaseDelayMs = 50;
+    int retryMaxDelayMs = 2000;
+    double retryBudgetRatio = 0.1;
+    double retryBudgetReserve = 10;
+    // Messages from the server wait in a lock-free queue of this many
+    // slots and are handled on a thread of their own, up to inboundBatch
+    // per wakeup (see mpsc_queue.hpp); 0 handles them on the transport's
+    // thread. When the queue is full, inboundOverflow "block" holds the
+    // transport's thread, "drop" discards the message.
+    int inboundQueueCapacity = 0;
+    int inboundBatch = 64;
+    std::string inboundOverflow = "block";
+    // Keep the last tool listing read to the end in a flat ToolCatalog,
+    // see mcp::cachedTools()
+    bool cacheToolList = false;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(McpServerConfig, name, description, autoReconnect, maxRetries, retryDelayMs)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(McpServerConfig, name, description, autoReconnect, maxRetries, retryDelayMs,
+                                                requestTimeoutMs, maxConcurrentHandlers, maxQueuedHandlers, circuitBreaker,
+                                                breakerWindowMs, breakerMinCalls, breakerFailureRate, breakerSlowCallMs,
+                                                breakerOpenMs, adaptiveConcurrency, concurrencyAlgorithm, initialConcurrency,
+                                                minConcurrency, maxConcurrency, maxQueuedRequests,
+                                                priorityWeights, rateLimit, toolRateLimits, rateLimitWaitMs,
+                                                propagateDeadlines, deadlineMarginMs, minDeadlineBudgetMs,
+                                                retryFailedCalls, maxCallAttempts, retryBaseDelayMs, retryMaxDelayMs,
+                                                retryBudgetRatio, retryBudgetReserve, inboundQueueCapacity, inboundBatch,
+                                                inboundOverflow, cacheToolList)
 };
 
-using ConnectionCallback = std::function<void(const std::string& serverId, ConnectionStatus status)>;
-using MessageCallback = std::function<void(const std::string& serverId, const McpMessage& message)>;
-using ErrorCallback = std::function<void(const std::string& serverId, const std::string& error)>;
+using ConnectionCallback = std::function<void(Symbol serverId, ConnectionStatus status)>;
+using MessageCallback = std::function<void(Symbol serverId, const McpMessage& message)>;
+using ErrorCallback = std::function<void(Symbol serverId, const std::string& error)>;
 
 struct McpServerInfo {
-    std::string id;
+    Symbol id;
     McpServerConfig config;
     std::unique_ptr<Transport> transport = nullptr;
     std::unique_ptr<McpTransportConfig> transportConfigJson = nullptr;
@@ -220,7 +350,7 @@ inline void to_json(nlohmann::json& j, const McpServerInfo& info) {
 }
 
 inline void from_json(const nlohmann::json& j, McpServerInfo& info) {
-    info.id = j.at("id").get<std::string>();
+    info.id = j.at("id").get<Symbol>();
     if (j.contains("config")) {
         info.config = j.at("config").get<McpServerConfig>();
     }
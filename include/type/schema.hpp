@@ -1,10 +1,12 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <variant>
 #include <boost/optional.hpp>
 #include <nlohmann/json.hpp>
+#include "symbol.hpp"
 
 namespace mcp {
 namespace type {
@@ -335,7 +337,7 @@ struct Result {
 struct JSONRPCRequest {
     std::string jsonrpc = "2.0";
     RequestId id;
-    std::string method;
+    Symbol method;
     
     struct Params {
         boost::optional<std::map<std::string, nlohmann::json>> _meta;
@@ -367,7 +369,7 @@ struct JSONRPCError {
 
 struct JSONRPCNotification {
     std::string jsonrpc = "2.0";
-    std::string method;
+    Symbol method;
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
@@ -377,7 +379,8 @@ struct JSONRPCNotification {
 
 // Initialize
 struct InitializeRequest {
-    std::string method = "initialize";
+    static constexpr std::string_view Method = "initialize";
+    Symbol method{Method};
     
     struct Params {
         std::string protocolVersion;
@@ -397,7 +400,8 @@ struct InitializeResult : Result {
 
 // List Tools
 struct ListToolsRequest {
-    std::string method = "tools/list";
+    static constexpr std::string_view Method = "tools/list";
+    Symbol method{Method};
     
     struct Params {
         boost::optional<Cursor> cursor;
@@ -413,7 +417,8 @@ struct ListToolsResult : Result {
 
 // Call Tool
 struct CallToolRequest {
-    std::string method = "tools/call";
+    static constexpr std::string_view Method = "tools/call";
+    Symbol method{Method};
     
     struct Params {
         std::string name;
@@ -431,7 +436,8 @@ struct CallToolResult : Result {
 
 // List Prompts
 struct ListPromptsRequest {
-    std::string method = "prompts/list";
+    static constexpr std::string_view Method = "prompts/list";
+    Symbol method{Method};
     
     struct Params {
         boost::optional<Cursor> cursor;
@@ -447,7 +453,8 @@ struct ListPromptsResult : Result {
 
 // Get Prompt
 struct GetPromptRequest {
-    std::string method = "prompts/get";
+    static constexpr std::string_view Method = "prompts/get";
+    Symbol method{Method};
     
     struct Params {
         std::string name;
@@ -464,7 +471,8 @@ struct GetPromptResult : Result {
 
 // List Resources
 struct ListResourcesRequest {
-    std::string method = "resources/list";
+    static constexpr std::string_view Method = "resources/list";
+    Symbol method{Method};
     
     struct Params {
         boost::optional<Cursor> cursor;
@@ -480,7 +488,8 @@ struct ListResourcesResult : Result {
 
 // Read Resource
 struct ReadResourceRequest {
-    std::string method = "resources/read";
+    static constexpr std::string_view Method = "resources/read";
+    Symbol method{Method};
     
     struct Params {
         std::string uri;
@@ -495,7 +504,8 @@ struct ReadResourceResult : Result {
 
 // Subscribe/Unsubscribe Resource
 struct SubscribeRequest {
-    std::string method = "resources/subscribe";
+    static constexpr std::string_view Method = "resources/subscribe";
+    Symbol method{Method};
     
     struct Params {
         std::string uri;
@@ -505,7 +515,8 @@ struct SubscribeRequest {
 };
 
 struct UnsubscribeRequest {
-    std::string method = "resources/unsubscribe";
+    static constexpr std::string_view Method = "resources/unsubscribe";
+    Symbol method{Method};
     
     struct Params {
         std::string uri;
@@ -516,7 +527,8 @@ struct UnsubscribeRequest {
 
 // List Resource Templates
 struct ListResourceTemplatesRequest {
-    std::string method = "resources/templates/list";
+    static constexpr std::string_view Method = "resources/templates/list";
+    Symbol method{Method};
     
     struct Params {
         boost::optional<Cursor> cursor;
@@ -532,7 +544,8 @@ struct ListResourceTemplatesResult : Result {
 
 // Completion
 struct CompleteRequest {
-    std::string method = "completion/complete";
+    static constexpr std::string_view Method = "completion/complete";
+    Symbol method{Method};
     
     struct Params {
         std::variant<PromptReference, ResourceTemplateReference> ref;
@@ -566,7 +579,8 @@ struct CompleteResult : Result {
 
 // Logging
 struct SetLevelRequest {
-    std::string method = "logging/setLevel";
+    static constexpr std::string_view Method = "logging/setLevel";
+    Symbol method{Method};
     
     struct Params {
         LoggingLevel level;
@@ -577,7 +591,8 @@ struct SetLevelRequest {
 
 // Sampling
 struct CreateMessageRequest {
-    std::string method = "sampling/createMessage";
+    static constexpr std::string_view Method = "sampling/createMessage";
+    Symbol method{Method};
     
     struct Params {
         std::vector<SamplingMessage> messages;
@@ -602,7 +617,8 @@ struct CreateMessageResult : Result {
 
 // Elicitation
 struct ElicitRequest {
-    std::string method = "elicitation/create";
+    static constexpr std::string_view Method = "elicitation/create";
+    Symbol method{Method};
     
     struct Params {
         std::string message;
@@ -626,7 +642,8 @@ struct ElicitResult : Result {
 
 // List Roots
 struct ListRootsRequest {
-    std::string method = "roots/list";
+    static constexpr std::string_view Method = "roots/list";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
@@ -636,7 +653,8 @@ struct ListRootsResult : Result {
 
 // Ping
 struct PingRequest {
-    std::string method = "ping";
+    static constexpr std::string_view Method = "ping";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
@@ -645,12 +663,14 @@ struct PingRequest {
 // ============================================================================
 
 struct InitializedNotification {
-    std::string method = "notifications/initialized";
+    static constexpr std::string_view Method = "notifications/initialized";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
 struct ProgressNotification {
-    std::string method = "notifications/progress";
+    static constexpr std::string_view Method = "notifications/progress";
+    Symbol method{Method};
     
     struct Params {
         ProgressToken progressToken;
@@ -663,7 +683,8 @@ struct ProgressNotification {
 };
 
 struct CancelledNotification {
-    std::string method = "notifications/cancelled";
+    static constexpr std::string_view Method = "notifications/cancelled";
+    Symbol method{Method};
     
     struct Params {
         RequestId requestId;
@@ -674,7 +695,8 @@ struct CancelledNotification {
 };
 
 struct LoggingMessageNotification {
-    std::string method = "notifications/message";
+    static constexpr std::string_view Method = "notifications/message";
+    Symbol method{Method};
     
     struct Params {
         LoggingLevel level;
@@ -686,7 +708,8 @@ struct LoggingMessageNotification {
 };
 
 struct ResourceUpdatedNotification {
-    std::string method = "notifications/resources/updated";
+    static constexpr std::string_view Method = "notifications/resources/updated";
+    Symbol method{Method};
     
     struct Params {
         std::string uri;
@@ -696,22 +719,26 @@ struct ResourceUpdatedNotification {
 };
 
 struct ResourceListChangedNotification {
-    std::string method = "notifications/resources/list_changed";
+    static constexpr std::string_view Method = "notifications/resources/list_changed";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
 struct ToolListChangedNotification {
-    std::string method = "notifications/tools/list_changed";
+    static constexpr std::string_view Method = "notifications/tools/list_changed";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
 struct PromptListChangedNotification {
-    std::string method = "notifications/prompts/list_changed";
+    static constexpr std::string_view Method = "notifications/prompts/list_changed";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
 struct RootsListChangedNotification {
-    std::string method = "notifications/roots/list_changed";
+    static constexpr std::string_view Method = "notifications/roots/list_changed";
+    Symbol method{Method};
     boost::optional<std::map<std::string, nlohmann::json>> params;
 };
 
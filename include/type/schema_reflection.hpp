@@ -0,0 +1,247 @@
+#pragma once
+#include "schema.hpp"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Field Lists
+// ============================================================================
+//
+// One field list per struct. Both the nlohmann::json serializers in
+// schema_serialization.hpp and the streaming writer in schema_writer.hpp are
+// generated from these lists, so the two output paths cannot drift apart.
+// boost::optional members are omitted when empty, every other member is
+// always written.
+
+template <class T, class M>
+struct Field {
+    const char* name;
+    M T::*member;
+};
+
+template <class T, class M, class B>
+constexpr Field<T, M> field(const char* name, M B::*member) {
+    return Field<T, M>{name, static_cast<M T::*>(member)};
+}
+
+template <class T>
+struct Reflect;
+
+template <class T, class = void>
+struct is_reflected : std::false_type {};
+
+template <class T>
+struct is_reflected<T, std::void_t<decltype(Reflect<T>::fields)>> : std::true_type {};
+
+template <class T>
+struct is_optional : std::false_type {};
+
+template <class T>
+struct is_optional<boost::optional<T>> : std::true_type {};
+
+template <class T>
+struct is_variant : std::false_type {};
+
+template <class... Ts>
+struct is_variant<std::variant<Ts...>> : std::true_type {};
+
+template <class T, class F>
+inline void forEachField(const T& value, F&& fn) {
+    std::apply([&](const auto&... f) {
+        (fn(f.name, value.*(f.member)), ...);
+    }, Reflect<T>::fields);
+}
+
+// ============================================================================
+// Content Blocks
+// ============================================================================
+
+template <> struct Reflect<Annotations> {
+    static constexpr auto fields = std::make_tuple(
+        field<Annotations>("audience", &Annotations::audience),
+        field<Annotations>("lastModified", &Annotations::lastModified),
+        field<Annotations>("priority", &Annotations::priority));
+};
+
+template <> struct Reflect<TextContent> {
+    static constexpr auto fields = std::make_tuple(
+        field<TextContent>("type", &TextContent::type),
+        field<TextContent>("text", &TextContent::text),
+        field<TextContent>("annotations", &TextContent::annotations),
+        field<TextContent>("_meta", &TextContent::_meta));
+};
+
+template <> struct Reflect<ImageContent> {
+    static constexpr auto fields = std::make_tuple(
+        field<ImageContent>("type", &ImageContent::type),
+        field<ImageContent>("data", &ImageContent::data),
+        field<ImageContent>("mimeType", &ImageContent::mimeType),
+        field<ImageContent>("annotations", &ImageContent::annotations),
+        field<ImageContent>("_meta", &ImageContent::_meta));
+};
+
+template <> struct Reflect<AudioContent> {
+    static constexpr auto fields = std::make_tuple(
+        field<AudioContent>("type", &AudioContent::type),
+        field<AudioContent>("data", &AudioContent::data),
+        field<AudioContent>("mimeType", &AudioContent::mimeType),
+        field<AudioContent>("annotations", &AudioContent::annotations),
+        field<AudioContent>("_meta", &AudioContent::_meta));
+};
+
+template <> struct Reflect<ResourceLink> {
+    static constexpr auto fields = std::make_tuple(
+        field<ResourceLink>("type", &ResourceLink::type),
+        field<ResourceLink>("uri", &ResourceLink::uri),
+        field<ResourceLink>("name", &ResourceLink::name),
+        field<ResourceLink>("title", &ResourceLink::title),
+        field<ResourceLink>("description", &ResourceLink::description),
+        field<ResourceLink>("mimeType", &ResourceLink::mimeType),
+        field<ResourceLink>("size", &ResourceLink::size),
+        field<ResourceLink>("annotations", &ResourceLink::annotations),
+        field<ResourceLink>("_meta", &ResourceLink::_meta));
+};
+
+template <> struct Reflect<TextResourceContents> {
+    static constexpr auto fields = std::make_tuple(
+        field<TextResourceContents>("uri", &TextResourceContents::uri),
+        field<TextResourceContents>("text", &TextResourceContents::text),
+        field<TextResourceContents>("mimeType", &TextResourceContents::mimeType),
+        field<TextResourceContents>("_meta", &TextResourceContents::_meta));
+};
+
+template <> struct Reflect<BlobResourceContents> {
+    static constexpr auto fields = std::make_tuple(
+        field<BlobResourceContents>("uri", &BlobResourceContents::uri),
+        field<BlobResourceContents>("blob", &BlobResourceContents::blob),
+        field<BlobResourceContents>("mimeType", &BlobResourceContents::mimeType),
+        field<BlobResourceContents>("_meta", &BlobResourceContents::_meta));
+};
+
+template <> struct Reflect<EmbeddedResource> {
+    static constexpr auto fields = std::make_tuple(
+        field<EmbeddedResource>("type", &EmbeddedResource::type),
+        field<EmbeddedResource>("resource", &EmbeddedResource::resource),
+        field<EmbeddedResource>("annotations", &EmbeddedResource::annotations),
+        field<EmbeddedResource>("_meta", &EmbeddedResource::_meta));
+};
+
+// ============================================================================
+// Tool Structures
+// ============================================================================
+
+template <> struct Reflect<ToolAnnotations> {
+    static constexpr auto fields = std::make_tuple(
+        field<ToolAnnotations>("title", &ToolAnnotations::title),
+        field<ToolAnnotations>("readOnlyHint", &ToolAnnotations::readOnlyHint),
+        field<ToolAnnotations>("destructiveHint", &ToolAnnotations::destructiveHint),
+        field<ToolAnnotations>("idempotentHint", &ToolAnnotations::idempotentHint),
+        field<ToolAnnotations>("openWorldHint", &ToolAnnotations::openWorldHint));
+};
+
+template <> struct Reflect<InputSchema> {
+    static constexpr auto fields = std::make_tuple(
+        field<InputSchema>("type", &InputSchema::type),
+        field<InputSchema>("properties", &InputSchema::properties),
+        field<InputSchema>("required", &InputSchema::required));
+};
+
+template <> struct Reflect<OutputSchema> {
+    static constexpr auto fields = std::make_tuple(
+        field<OutputSchema>("type", &OutputSchema::type),
+        field<OutputSchema>("properties", &OutputSchema::properties),
+        field<OutputSchema>("required", &OutputSchema::required));
+};
+
+template <> struct Reflect<Tool> {
+    static constexpr auto fields = std::make_tuple(
+        field<Tool>("name", &Tool::name),
+        field<Tool>("title", &Tool::title),
+        field<Tool>("description", &Tool::description),
+        field<Tool>("inputSchema", &Tool::inputSchema),
+        field<Tool>("outputSchema", &Tool::outputSchema),
+        field<Tool>("annotations", &Tool::annotations),
+        field<Tool>("_meta", &Tool::_meta));
+};
+
+// ============================================================================
+// Implementation Info and Capabilities
+// ============================================================================
+
+template <> struct Reflect<Implementation> {
+    static constexpr auto fields = std::make_tuple(
+        field<Implementation>("name", &Implementation::name),
+        field<Implementation>("title", &Implementation::title),
+        field<Implementation>("version", &Implementation::version));
+};
+
+template <> struct Reflect<ClientCapabilities::RootsCapability> {
+    static constexpr auto fields = std::make_tuple(
+        field<ClientCapabilities::RootsCapability>("listChanged", &ClientCapabilities::RootsCapability::listChanged));
+};
+
+template <> struct Reflect<ClientCapabilities::SamplingCapability> {
+    static constexpr auto fields = std::make_tuple();
+};
+
+template <> struct Reflect<ClientCapabilities::ElicitationCapability> {
+    static constexpr auto fields = std::make_tuple();
+};
+
+template <> struct Reflect<ClientCapabilities> {
+    static constexpr auto fields = std::make_tuple(
+        field<ClientCapabilities>("roots", &ClientCapabilities::roots),
+        field<ClientCapabilities>("sampling", &ClientCapabilities::sampling),
+        field<ClientCapabilities>("elicitation", &ClientCapabilities::elicitation),
+        field<ClientCapabilities>("experimental", &ClientCapabilities::experimental));
+};
+
+// ============================================================================
+// Request Params
+// ============================================================================
+
+template <> struct Reflect<InitializeRequest::Params> {
+    static constexpr auto fields = std::make_tuple(
+        field<InitializeRequest::Params>("protocolVersion", &InitializeRequest::Params::protocolVersion),
+        field<InitializeRequest::Params>("capabilities", &InitializeRequest::Params::capabilities),
+        field<InitializeRequest::Params>("clientInfo", &InitializeRequest::Params::clientInfo));
+};
+
+// ============================================================================
+// Generic nlohmann::json conversion
+// ============================================================================
+
+template <class T>
+inline nlohmann::json reflectToJson(const T& value);
+
+template <class V>
+inline nlohmann::json reflectValueToJson(const V& v) {
+    if constexpr (is_reflected<V>::value) {
+        return reflectToJson(v);
+    } else if constexpr (is_variant<V>::value) {
+        return std::visit([](const auto& alt) { return reflectValueToJson(alt); }, v);
+    } else {
+        return nlohmann::json(v);
+    }
+}
+
+template <class T>
+inline nlohmann::json reflectToJson(const T& value) {
+    nlohmann::json j = nlohmann::json::object();
+    forEachField(value, [&](const char* name, const auto& member) {
+        using M = std::decay_t<decltype(member)>;
+        if constexpr (is_optional<M>::value) {
+            if (member) j[name] = reflectValueToJson(*member);
+        } else {
+            j[name] = reflectValueToJson(member);
+        }
+    });
+    return j;
+}
+
+} // namespace type
+} // namespace mcp
@@ -1,5 +1,6 @@
 #pragma once
 #include "schema.hpp"
+#include "schema_reflection.hpp"
 #include <nlohmann/json.hpp>
 
 namespace mcp {
@@ -39,10 +40,7 @@ inline void from_json(const nlohmann::json& j, BaseMetadata& b) {
 }
 
 inline void to_json(nlohmann::json& j, const Annotations& a) {
-    j = nlohmann::json::object();
-    if (a.audience) j["audience"] = *a.audience;
-    if (a.lastModified) j["lastModified"] = *a.lastModified;
-    if (a.priority) j["priority"] = *a.priority;
+    j = reflectToJson(a);
 }
 
 inline void from_json(const nlohmann::json& j, Annotations& a) {
@@ -56,12 +54,7 @@ inline void from_json(const nlohmann::json& j, Annotations& a) {
 // ============================================================================
 
 inline void to_json(nlohmann::json& j, const TextContent& t) {
-    j = nlohmann::json{
-        {"type", "text"},
-        {"text", t.text}
-    };
-    if (t.annotations) j["annotations"] = *t.annotations;
-    if (t._meta) j["_meta"] = *t._meta;
+    j = reflectToJson(t);
 }
 
 inline void from_json(const nlohmann::json& j, TextContent& t) {
@@ -71,13 +64,7 @@ inline void from_json(const nlohmann::json& j, TextContent& t) {
 }
 
 inline void to_json(nlohmann::json& j, const ImageContent& i) {
-    j = nlohmann::json{
-        {"type", "image"},
-        {"data", i.data},
-        {"mimeType", i.mimeType}
-    };
-    if (i.annotations) j["annotations"] = *i.annotations;
-    if (i._meta) j["_meta"] = *i._meta;
+    j = reflectToJson(i);
 }
 
 inline void from_json(const nlohmann::json& j, ImageContent& i) {
@@ -88,13 +75,7 @@ inline void from_json(const nlohmann::json& j, ImageContent& i) {
 }
 
 inline void to_json(nlohmann::json& j, const AudioContent& a) {
-    j = nlohmann::json{
-        {"type", "audio"},
-        {"data", a.data},
-        {"mimeType", a.mimeType}
-    };
-    if (a.annotations) j["annotations"] = *a.annotations;
-    if (a._meta) j["_meta"] = *a._meta;
+    j = reflectToJson(a);
 }
 
 inline void from_json(const nlohmann::json& j, AudioContent& a) {
@@ -104,17 +85,28 @@ inline void from_json(const nlohmann::json& j, AudioContent& a) {
     if (j.contains("_meta")) a._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
 }
 
+inline void to_json(nlohmann::json& j, const ResourceLink& r) {
+    j = reflectToJson(r);
+}
+
+inline void to_json(nlohmann::json& j, const TextResourceContents& t) {
+    j = reflectToJson(t);
+}
+
+inline void to_json(nlohmann::json& j, const BlobResourceContents& b) {
+    j = reflectToJson(b);
+}
+
+inline void to_json(nlohmann::json& j, const EmbeddedResource& e) {
+    j = reflectToJson(e);
+}
+
 // ============================================================================
 // JSON Serialization for Tool Structures
 // ============================================================================
 
 inline void to_json(nlohmann::json& j, const ToolAnnotations& t) {
-    j = nlohmann::json::object();
-    if (t.title) j["title"] = *t.title;
-    if (t.readOnlyHint) j["readOnlyHint"] = *t.readOnlyHint;
-    if (t.destructiveHint) j["destructiveHint"] = *t.destructiveHint;
-    if (t.idempotentHint) j["idempotentHint"] = *t.idempotentHint;
-    if (t.openWorldHint) j["openWorldHint"] = *t.openWorldHint;
+    j = reflectToJson(t);
 }
 
 inline void from_json(const nlohmann::json& j, ToolAnnotations& t) {
@@ -126,9 +118,7 @@ inline void from_json(const nlohmann::json& j, ToolAnnotations& t) {
 }
 
 inline void to_json(nlohmann::json& j, const InputSchema& i) {
-    j = nlohmann::json{{"type", "object"}};
-    if (i.properties) j["properties"] = *i.properties;
-    if (i.required) j["required"] = *i.required;
+    j = reflectToJson(i);
 }
 
 inline void from_json(const nlohmann::json& j, InputSchema& i) {
@@ -137,9 +127,7 @@ inline void from_json(const nlohmann::json& j, InputSchema& i) {
 }
 
 inline void to_json(nlohmann::json& j, const OutputSchema& o) {
-    j = nlohmann::json{{"type", "object"}};
-    if (o.properties) j["properties"] = *o.properties;
-    if (o.required) j["required"] = *o.required;
+    j = reflectToJson(o);
 }
 
 inline void from_json(const nlohmann::json& j, OutputSchema& o) {
@@ -148,15 +136,7 @@ inline void from_json(const nlohmann::json& j, OutputSchema& o) {
 }
 
 inline void to_json(nlohmann::json& j, const Tool& t) {
-    j = nlohmann::json{
-        {"name", t.name},
-        {"inputSchema", t.inputSchema}
-    };
-    if (t.title) j["title"] = *t.title;
-    if (t.description) j["description"] = *t.description;
-    if (t.outputSchema) j["outputSchema"] = *t.outputSchema;
-    if (t.annotations) j["annotations"] = *t.annotations;
-    if (t._meta) j["_meta"] = *t._meta;
+    j = reflectToJson(t);
 }
 
 inline void from_json(const nlohmann::json& j, Tool& t) {
@@ -199,6 +179,16 @@ inline void from_json(const nlohmann::json& j, Resource& r) {
     if (j.contains("_meta")) r._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
 }
 
+inline void from_json(const nlohmann::json& j, ResourceTemplate& r) {
+    j.at("name").get_to(r.name);
+    j.at("uriTemplate").get_to(r.uriTemplate);
+    if (j.contains("title")) r.title = j.at("title").get<std::string>();
+    if (j.contains("description")) r.description = j.at("description").get<std::string>();
+    if (j.contains("mimeType")) r.mimeType = j.at("mimeType").get<std::string>();
+    if (j.contains("annotations")) r.annotations = j.at("annotations").get<Annotations>();
+    if (j.contains("_meta")) r._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
+}
+
 // ============================================================================
 // JSON Serialization for Prompt Structures
 // ============================================================================
@@ -238,11 +228,7 @@ inline void from_json(const nlohmann::json& j, Prompt& p) {
 // ============================================================================
 
 inline void to_json(nlohmann::json& j, const Implementation& i) {
-    j = nlohmann::json{
-        {"name", i.name},
-        {"version", i.version}
-    };
-    if (i.title) j["title"] = *i.title;
+    j = reflectToJson(i);
 }
 
 inline void from_json(const nlohmann::json& j, Implementation& i) {
@@ -256,15 +242,7 @@ inline void from_json(const nlohmann::json& j, Implementation& i) {
 // ============================================================================
 
 inline void to_json(nlohmann::json& j, const ClientCapabilities& c) {
-    j = nlohmann::json::object();
-    if (c.roots) {
-        nlohmann::json roots_obj = nlohmann::json::object();
-        if (c.roots->listChanged) roots_obj["listChanged"] = *c.roots->listChanged;
-        j["roots"] = roots_obj;
-    }
-    if (c.sampling) j["sampling"] = nlohmann::json::object();
-    if (c.elicitation) j["elicitation"] = nlohmann::json::object();
-    if (c.experimental) j["experimental"] = *c.experimental;
+    j = reflectToJson(c);
 }
 
 inline void from_json(const nlohmann::json& j, ClientCapabilities& c) {
@@ -345,11 +323,7 @@ inline void from_json(const nlohmann::json& j, ServerCapabilities& s) {
 // ============================================================================
 
 inline void to_json(nlohmann::json& j, const InitializeRequest::Params& p) {
-    j = nlohmann::json{
-        {"protocolVersion", p.protocolVersion},
-        {"capabilities", p.capabilities},
-        {"clientInfo", p.clientInfo}
-    };
+    j = reflectToJson(p);
 }
 
 inline void from_json(const nlohmann::json& j, InitializeRequest::Params& p) {
@@ -388,6 +362,206 @@ inline void from_json(const nlohmann::json& j, ListToolsResult& r) {
     if (j.contains("_meta")) r._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
 }
 
+inline void from_json(const nlohmann::json& j, ListPromptsResult& r) {
+    j.at("prompts").get_to(r.prompts);
+    if (j.contains("nextCursor")) r.nextCursor = j.at("nextCursor").get<std::string>();
+    if (j.contains("_meta")) r._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
+}
+
+inline void from_json(const nlohmann::json& j, ListResourcesResult& r) {
+    j.at("resources").get_to(r.resources);
+    if (j.contains("nextCursor")) r.nextCursor = j.at("nextCursor").get<std::string>();
+    if (j.contains("_meta")) r._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
+}
+
+inline void from_json(const nlohmann::json& j, ListResourceTemplatesResult& r) {
+    j.at("resourceTemplates").get_to(r.resourceTemplates);
+    if (j.contains("nextCursor")) r.nextCursor = j.at("nextCursor").get<std::string>();
+    if (j.contains("_meta")) r._meta = j.at("_meta").get<std::map<std::string, nlohmann::json>>();
+}
+
+// ============================================================================
+// JSON Serialization for Request Ids and Progress Tokens
+// ============================================================================
+
+inline std::variant<std::string, int64_t> idFromJson(const nlohmann::json& j) {
+    if (j.is_string()) return j.get<std::string>();
+    return j.get<int64_t>();
+}
+
+inline nlohmann::json idToJson(const std::variant<std::string, int64_t>& id) {
+    return std::visit([](const auto& v) { return nlohmann::json(v); }, id);
+}
+
+// ============================================================================
+// JSON Serialization for Sampling Structures
+// ============================================================================
+
+inline void from_json(const nlohmann::json& j, std::variant<TextContent, ImageContent, AudioContent>& c) {
+    const auto type = j.at("type").get<std::string>();
+    if (type == "image") {
+        c = j.get<ImageContent>();
+    } else if (type == "audio") {
+        c = j.get<AudioContent>();
+    } else {
+        c = j.get<TextContent>();
+    }
+}
+
+inline void from_json(const nlohmann::json& j, SamplingMessage& m) {
+    j.at("role").get_to(m.role);
+    from_json(j.at("content"), m.content);
+}
+
+inline void from_json(const nlohmann::json& j, ModelHint& h) {
+    if (j.contains("name")) h.name = j.at("name").get<std::string>();
+}
+
+inline void from_json(const nlohmann::json& j, ModelPreferences& p) {
+    if (j.contains("hints")) p.hints = j.at("hints").get<std::vector<ModelHint>>();
+    if (j.contains("costPriority")) p.costPriority = j.at("costPriority").get<double>();
+    if (j.contains("speedPriority")) p.speedPriority = j.at("speedPriority").get<double>();
+    if (j.contains("intelligencePriority")) p.intelligencePriority = j.at("intelligencePriority").get<double>();
+}
+
+inline void from_json(const nlohmann::json& j, CreateMessageRequest::Params& p) {
+    j.at("messages").get_to(p.messages);
+    j.at("maxTokens").get_to(p.maxTokens);
+    if (j.contains("systemPrompt")) p.systemPrompt = j.at("systemPrompt").get<std::string>();
+    if (j.contains("modelPreferences")) p.modelPreferences = j.at("modelPreferences").get<ModelPreferences>();
+    if (j.contains("stopSequences")) p.stopSequences = j.at("stopSequences").get<std::vector<std::string>>();
+    if (j.contains("temperature")) p.temperature = j.at("temperature").get<double>();
+    if (j.contains("includeContext")) p.includeContext = j.at("includeContext").get<std::string>();
+    if (j.contains("metadata")) p.metadata = j.at("metadata");
+}
+
+inline void to_json(nlohmann::json& j, const CreateMessageResult& r) {
+    j = nlohmann::json{
+        {"role", r.role},
+        {"content", std::visit([](const auto& c) { return nlohmann::json(c); }, r.content)},
+        {"model", r.model}
+    };
+    if (r.stopReason) j["stopReason"] = *r.stopReason;
+    if (r._meta) j["_meta"] = *r._meta;
+}
+
+// ============================================================================
+// JSON Serialization for Elicitation Structures
+// ============================================================================
+
+inline void from_json(const nlohmann::json& j, StringSchema& s) {
+    if (j.contains("description")) s.description = j.at("description").get<std::string>();
+    if (j.contains("title")) s.title = j.at("title").get<std::string>();
+    if (j.contains("format")) s.format = j.at("format").get<std::string>();
+    if (j.contains("minLength")) s.minLength = j.at("minLength").get<int64_t>();
+    if (j.contains("maxLength")) s.maxLength = j.at("maxLength").get<int64_t>();
+}
+
+inline void from_json(const nlohmann::json& j, NumberSchema& n) {
+    j.at("type").get_to(n.type);
+    if (j.contains("description")) n.description = j.at("description").get<std::string>();
+    if (j.contains("title")) n.title = j.at("title").get<std::string>();
+    if (j.contains("minimum")) n.minimum = j.at("minimum").get<double>();
+    if (j.contains("maximum")) n.maximum = j.at("maximum").get<double>();
+}
+
+inline void from_json(const nlohmann::json& j, BooleanSchema& b) {
+    if (j.contains("description")) b.description = j.at("description").get<std::string>();
+    if (j.contains("title")) b.title = j.at("title").get<std::string>();
+    if (j.contains("default")) b.defaultValue = j.at("default").get<bool>();
+}
+
+inline void from_json(const nlohmann::json& j, EnumSchema& e) {
+    j.at("enum").get_to(e.enumValues);
+    if (j.contains("enumNames")) e.enumNames = j.at("enumNames").get<std::vector<std::string>>();
+    if (j.contains("description")) e.description = j.at("description").get<std::string>();
+    if (j.contains("title")) e.title = j.at("title").get<std::string>();
+}
+
+inline void from_json(const nlohmann::json& j, PrimitiveSchemaDefinition& s) {
+    const auto type = j.at("type").get<std::string>();
+    if (type == "number" || type == "integer") {
+        s = j.get<NumberSchema>();
+    } else if (type == "boolean") {
+        s = j.get<BooleanSchema>();
+    } else if (j.contains("enum")) {
+        s = j.get<EnumSchema>();
+    } else {
+        s = j.get<StringSchema>();
+    }
+}
+
+inline void from_json(const nlohmann::json& j, ElicitRequest::Params& p) {
+    j.at("message").get_to(p.message);
+    const auto& schema = j.at("requestedSchema");
+    if (schema.contains("properties")) {
+        for (const auto& [name, prop] : schema.at("properties").items()) {
+            PrimitiveSchemaDefinition def;
+            from_json(prop, def);
+            p.requestedSchema.properties.emplace(name, std::move(def));
+        }
+    }
+    if (schema.contains("required")) p.requestedSchema.required = schema.at("required").get<std::vector<std::string>>();
+}
+
+inline void to_json(nlohmann::json& j, const ElicitResult& r) {
+    j = nlohmann::json{{"action", r.action}};
+    if (r.content) {
+        nlohmann::json content = nlohmann::json::object();
+        for (const auto& [key, value] : *r.content) {
+            content[key] = std::visit([](const auto& v) { return nlohmann::json(v); }, value);
+        }
+        j["content"] = content;
+    }
+    if (r._meta) j["_meta"] = *r._meta;
+}
+
+// ============================================================================
+// JSON Serialization for Root Structures
+// ============================================================================
+
+inline void to_json(nlohmann::json& j, const Root& r) {
+    j = nlohmann::json{{"uri", r.uri}};
+    if (r.name) j["name"] = *r.name;
+    if (r._meta) j["_meta"] = *r._meta;
+}
+
+inline void to_json(nlohmann::json& j, const ListRootsResult& r) {
+    j = nlohmann::json{{"roots", r.roots}};
+    if (r._meta) j["_meta"] = *r._meta;
+}
+
+// ============================================================================
+// JSON Serialization for Notification Params
+// ============================================================================
+
+inline void from_json(const nlohmann::json& j, ProgressNotification::Params& p) {
+    p.progressToken = idFromJson(j.at("progressToken"));
+    j.at("progress").get_to(p.progress);
+    if (j.contains("total")) p.total = j.at("total").get<double>();
+    if (j.contains("message")) p.message = j.at("message").get<std::string>();
+}
+
+inline void from_json(const nlohmann::json& j, CancelledNotification::Params& p) {
+    p.requestId = idFromJson(j.at("requestId"));
+    if (j.contains("reason")) p.reason = j.at("reason").get<std::string>();
+}
+
+inline void to_json(nlohmann::json& j, const CancelledNotification::Params& p) {
+    j = nlohmann::json{{"requestId", idToJson(p.requestId)}};
+    if (p.reason) j["reason"] = *p.reason;
+}
+
+inline void from_json(const nlohmann::json& j, LoggingMessageNotification::Params& p) {
+    j.at("level").get_to(p.level);
+    p.data = j.value("data", nlohmann::json());
+    if (j.contains("logger")) p.logger = j.at("logger").get<std::string>();
+}
+
+inline void from_json(const nlohmann::json& j, ResourceUpdatedNotification::Params& p) {
+    j.at("uri").get_to(p.uri);
+}
+
 // Add more serialization functions as needed...
 } // namespace type
 } // namespace mcp
\ No newline at end of file
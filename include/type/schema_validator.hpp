@@ -0,0 +1,509 @@
+#pragma once
+#include "schema.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Compiled Schema Validation
+// ============================================================================
+//
+// A JSON Schema is compiled once into a flat array of nodes; validating a
+// value is then a walk over that array with no allocation on success. Object
+// properties are stored sorted by name, the same order as the keys of a
+// nlohmann object, so matching arguments against the schema is a single
+// merge pass instead of a lookup per key.
+//
+// Supported keywords: type (string or array), properties, required,
+// additionalProperties (bool or schema), items, enum, const, minimum,
+// maximum, exclusiveMinimum, exclusiveMaximum, minLength, maxLength,
+// minItems, maxItems. Other keywords are accepted and ignored.
+
+struct SchemaError {
+    std::string path;     // JSON pointer to the offending value, "" for the root
+    std::string message;
+};
+
+class CompiledSchema {
+public:
+    enum TypeBit : uint8_t {
+        Null = 1, Boolean = 2, Integer = 4, Number = 8, String = 16, Array = 32, Object = 64,
+        AnyType = 0x7F,
+    };
+
+    bool validate(const nlohmann::json& value, SchemaError* error = nullptr) const {
+        return nodes.empty() || check(0, value, error);
+    }
+
+    // Builders
+
+    static CompiledSchema compile(const nlohmann::json& schema) {
+        CompiledSchema c;
+        c.add(schema);
+        return c;
+    }
+
+    static CompiledSchema compile(const InputSchema& schema) {
+        return compileObject(schema.type, schema.properties, schema.required);
+    }
+
+    static CompiledSchema compile(const OutputSchema& schema) {
+        return compileObject(schema.type, schema.properties, schema.required);
+    }
+
+    static CompiledSchema compile(const PrimitiveSchemaDefinition& schema) {
+        CompiledSchema c;
+        c.add(schema);
+        return c;
+    }
+
+    static CompiledSchema compile(const ElicitRequest::Params::RequestedSchema& schema) {
+        CompiledSchema c;
+        const uint32_t root = c.alloc();
+        c.nodes[root].types = typeBits(schema.type);
+        std::vector<std::pair<std::string, uint32_t>> props;
+        for (const auto& [name, def] : schema.properties) {
+            props.emplace_back(name, c.add(def));
+        }
+        c.attachProperties(root, std::move(props), schema.required ? *schema.required : std::vector<std::string>{});
+        return c;
+    }
+
+private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    enum Flag : uint16_t {
+        HasMinimum = 1, HasMaximum = 2, ExclusiveMinimum = 4, ExclusiveMaximum = 8,
+        NoAdditional = 16, HasEnum = 32,
+    };
+
+    struct Node {
+        uint8_t types = AnyType;
+        uint16_t flags = 0;
+        double minimum = 0;
+        double maximum = 0;
+        uint32_t minLength = 0;
+        uint32_t maxLength = None;
+        uint32_t minItems = 0;
+        uint32_t maxItems = None;
+        uint32_t items = None;
+        uint32_t additional = None;
+        uint32_t firstProperty = 0;
+        uint32_t propertyCount = 0;
+        uint32_t requiredCount = 0;
+        uint32_t firstEnum = 0;
+        uint32_t enumCount = 0;
+    };
+
+    struct Property {
+        std::string name;
+        uint32_t node;
+        bool required;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Property> properties;
+    std::vector<nlohmann::json> enums;
+
+    static uint8_t typeBit(std::string_view t) {
+        if (t == "null") return Null;
+        if (t == "boolean") return Boolean;
+        if (t == "integer") return Integer;
+        if (t == "number") return Number | Integer;
+        if (t == "string") return String;
+        if (t == "array") return Array;
+        if (t == "object") return Object;
+        return AnyType;
+    }
+
+    static uint8_t typeBits(std::string_view t) {
+        return t.empty() ? static_cast<uint8_t>(AnyType) : typeBit(t);
+    }
+
+    static uint8_t typeOf(const nlohmann::json& v) {
+        switch (v.type()) {
+            case nlohmann::json::value_t::null: return Null;
+            case nlohmann::json::value_t::boolean: return Boolean;
+            case nlohmann::json::value_t::number_integer:
+            case nlohmann::json::value_t::number_unsigned: return Integer;
+            case nlohmann::json::value_t::number_float: {
+                const double d = v.get<double>();
+                return std::isfinite(d) && d == std::floor(d) ? Integer : Number;
+            }
+            case nlohmann::json::value_t::string: return String;
+            case nlohmann::json::value_t::array: return Array;
+            case nlohmann::json::value_t::object: return Object;
+            default: return 0;
+        }
+    }
+
+    // Reads a length/item bound: a non-negative integer, possibly written as
+    // an integral float (5.0). Anything else leaves `out` unchanged.
+    static void count(const nlohmann::json& v, uint32_t& out) {
+        if (v.is_number_unsigned() || (v.is_number_integer() && v.get<int64_t>() >= 0)) {
+            out = static_cast<uint32_t>(std::min<uint64_t>(v.get<uint64_t>(), None - 1));
+        } else if (v.is_number_float()) {
+            const double d = v.get<double>();
+            if (d >= 0 && d == std::floor(d)) out = static_cast<uint32_t>(std::min<double>(d, None - 1));
+        }
+    }
+
+    static size_t codePoints(const std::string& s) {
+        size_t n = 0;
+        for (unsigned char c : s) n += (c & 0xC0) != 0x80;
+        return n;
+    }
+
+    uint32_t alloc() {
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    static CompiledSchema compileObject(const std::string& type,
+                                        const boost::optional<std::map<std::string, nlohmann::json>>& props,
+                                        const boost::optional<std::vector<std::string>>& required) {
+        CompiledSchema c;
+        const uint32_t root = c.alloc();
+        c.nodes[root].types = typeBits(type);
+        std::vector<std::pair<std::string, uint32_t>> compiled;
+        if (props) {
+            for (const auto& [name, schema] : *props) {
+                compiled.emplace_back(name, c.add(schema));
+            }
+        }
+        c.attachProperties(root, std::move(compiled), required ? *required : std::vector<std::string>{});
+        return c;
+    }
+
+    // Properties are appended as one sorted run; required names without a
+    // property schema get an unconstrained node
+    void attachProperties(uint32_t node, std::vector<std::pair<std::string, uint32_t>> props,
+                          const std::vector<std::string>& required) {
+        for (const auto& r : required) {
+            auto it = std::find_if(props.begin(), props.end(), [&](const auto& p) { return p.first == r; });
+            if (it == props.end()) props.emplace_back(r, alloc());
+        }
+        std::sort(props.begin(), props.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        Node& n = nodes[node];
+        n.firstProperty = static_cast<uint32_t>(properties.size());
+        n.propertyCount = static_cast<uint32_t>(props.size());
+        for (auto& [name, child] : props) {
+            const bool isRequired = std::find(required.begin(), required.end(), name) != required.end();
+            n.requiredCount += isRequired;
+            properties.push_back({std::move(name), child, isRequired});
+        }
+    }
+
+    uint32_t add(const nlohmann::json& schema) {
+        const uint32_t self = alloc();
+        if (!schema.is_object()) {
+            // `true`/`{}` accept anything, `false` accepts nothing
+            if (schema.is_boolean() && !schema.get<bool>()) nodes[self].types = 0;
+            return self;
+        }
+        Node n;
+        if (auto it = schema.find("type"); it != schema.end()) {
+            if (it->is_string()) {
+                n.types = typeBit(it->get_ref<const std::string&>());
+            } else if (it->is_array()) {
+                n.types = 0;
+                for (const auto& t : *it) {
+                    if (t.is_string()) n.types |= typeBit(t.get_ref<const std::string&>());
+                }
+            }
+        }
+        auto number = [&](const char* key, Flag flag, double& out) {
+            auto it = schema.find(key);
+            if (it != schema.end() && it->is_number()) {
+                out = it->get<double>();
+                n.flags |= flag;
+            }
+        };
+        number("minimum", HasMinimum, n.minimum);
+        number("maximum", HasMaximum, n.maximum);
+        // Draft 6+: numeric exclusive bounds
+        if (auto it = schema.find("exclusiveMinimum"); it != schema.end() && it->is_number()) {
+            n.minimum = it->get<double>();
+            n.flags |= HasMinimum | ExclusiveMinimum;
+        }
+        if (auto it = schema.find("exclusiveMaximum"); it != schema.end() && it->is_number()) {
+            n.maximum = it->get<double>();
+            n.flags |= HasMaximum | ExclusiveMaximum;
+        }
+        if (auto it = schema.find("minLength"); it != schema.end()) count(*it, n.minLength);
+        if (auto it = schema.find("maxLength"); it != schema.end()) count(*it, n.maxLength);
+        if (auto it = schema.find("minItems"); it != schema.end()) count(*it, n.minItems);
+        if (auto it = schema.find("maxItems"); it != schema.end()) count(*it, n.maxItems);
+
+        auto enumIt = schema.find("enum");
+        auto constIt = schema.find("const");
+        if ((enumIt != schema.end() && enumIt->is_array()) || constIt != schema.end()) {
+            n.flags |= HasEnum;
+            n.firstEnum = static_cast<uint32_t>(enums.size());
+            if (constIt != schema.end()) {
+                enums.push_back(*constIt);
+            } else {
+                enums.insert(enums.end(), enumIt->begin(), enumIt->end());
+            }
+            n.enumCount = static_cast<uint32_t>(enums.size()) - n.firstEnum;
+        }
+        nodes[self] = n;
+
+        if (auto it = schema.find("items"); it != schema.end() && (it->is_object() || it->is_boolean())) {
+            const uint32_t items = add(*it);
+            nodes[self].items = items;
+        }
+        if (auto it = schema.find("additionalProperties"); it != schema.end()) {
+            if (it->is_boolean()) {
+                if (!it->get<bool>()) nodes[self].flags |= NoAdditional;
+            } else if (it->is_object()) {
+                const uint32_t additional = add(*it);
+                nodes[self].additional = additional;
+            }
+        }
+        auto propsIt = schema.find("properties");
+        auto reqIt = schema.find("required");
+        if ((propsIt != schema.end() && propsIt->is_object()) || (reqIt != schema.end() && reqIt->is_array())) {
+            std::vector<std::pair<std::string, uint32_t>> props;
+            if (propsIt != schema.end() && propsIt->is_object()) {
+                for (auto it = propsIt->begin(); it != propsIt->end(); ++it) {
+                    props.emplace_back(it.key(), add(it.value()));
+                }
+            }
+            std::vector<std::string> required;
+            if (reqIt != schema.end() && reqIt->is_array()) {
+                for (const auto& r : *reqIt) {
+                    if (r.is_string()) required.push_back(r.get<std::string>());
+                }
+            }
+            attachProperties(self, std::move(props), required);
+        }
+        return self;
+    }
+
+    uint32_t add(const PrimitiveSchemaDefinition& def) {
+        const uint32_t self = alloc();
+        Node& n = nodes[self];
+        std::visit([&](const auto& s) {
+            using S = std::decay_t<decltype(s)>;
+            n.types = typeBits(s.type);
+            if constexpr (std::is_same_v<S, StringSchema>) {
+                if (s.minLength) n.minLength = static_cast<uint32_t>(std::max<int64_t>(*s.minLength, 0));
+                if (s.maxLength) n.maxLength = static_cast<uint32_t>(std::max<int64_t>(*s.maxLength, 0));
+            } else if constexpr (std::is_same_v<S, NumberSchema>) {
+                if (s.minimum) { n.minimum = *s.minimum; n.flags |= HasMinimum; }
+                if (s.maximum) { n.maximum = *s.maximum; n.flags |= HasMaximum; }
+            } else if constexpr (std::is_same_v<S, EnumSchema>) {
+                n.flags |= HasEnum;
+                n.firstEnum = static_cast<uint32_t>(enums.size());
+                for (const auto& e : s.enumValues) enums.emplace_back(e);
+                n.enumCount = static_cast<uint32_t>(s.enumValues.size());
+            }
+        }, def);
+        return self;
+    }
+
+    // Failure paths only: build the message and prefix the path while unwinding
+    static bool fail(SchemaError* error, std::string message) {
+        if (error) {
+            error->path.clear();
+            error->message = std::move(message);
+        }
+        return false;
+    }
+
+    static bool prefix(SchemaError* error, std::string_view segment) {
+        if (error) {
+            std::string escaped;
+            for (char c : segment) {
+                if (c == '~') escaped += "~0";
+                else if (c == '/') escaped += "~1";
+                else escaped += c;
+            }
+            error->path.insert(0, "/" + escaped);
+        }
+        return false;
+    }
+
+    bool check(uint32_t index, const nlohmann::json& value, SchemaError* error) const {
+        const Node& n = nodes[index];
+        const uint8_t type = typeOf(value);
+        if (!(n.types & type)) {
+            return fail(error, std::string("expected ") + typeNames(n.types) + ", got " + value.type_name());
+        }
+        if (n.flags & HasEnum) {
+            bool found = false;
+            for (uint32_t i = 0; i < n.enumCount && !found; ++i) {
+                found = enums[n.firstEnum + i] == value;
+            }
+            if (!found) return fail(error, "value is not one of the allowed values");
+        }
+        switch (value.type()) {
+            case nlohmann::json::value_t::number_integer:
+            case nlohmann::json::value_t::number_unsigned:
+            case nlohmann::json::value_t::number_float:
+                return checkNumber(n, value.get<double>(), error);
+            case nlohmann::json::value_t::string: {
+                if (n.minLength == 0 && n.maxLength == None) return true;
+                const size_t len = codePoints(value.get_ref<const std::string&>());
+                if (len < n.minLength) return fail(error, "string shorter than " + std::to_string(n.minLength));
+                if (len > n.maxLength) return fail(error, "string longer than " + std::to_string(n.maxLength));
+                return true;
+            }
+            case nlohmann::json::value_t::array: {
+                if (value.size() < n.minItems) return fail(error, "fewer than " + std::to_string(n.minItems) + " items");
+                if (value.size() > n.maxItems) return fail(error, "more than " + std::to_string(n.maxItems) + " items");
+                if (n.items != None) {
+                    for (size_t i = 0; i < value.size(); ++i) {
+                        if (!check(n.items, value[i], error)) return prefix(error, std::to_string(i));
+                    }
+                }
+                return true;
+            }
+            case nlohmann::json::value_t::object:
+                return checkObject(n, value, error);
+            default:
+                return true;
+        }
+    }
+
+    static bool checkNumber(const Node& n, double d, SchemaError* error) {
+        if (n.flags & HasMinimum) {
+            if ((n.flags & ExclusiveMinimum) ? d <= n.minimum : d < n.minimum) {
+                return fail(error, "value below minimum " + nlohmann::json(n.minimum).dump());
+            }
+        }
+        if (n.flags & HasMaximum) {
+            if ((n.flags & ExclusiveMaximum) ? d >= n.maximum : d > n.maximum) {
+                return fail(error, "value above maximum " + nlohmann::json(n.maximum).dump());
+            }
+        }
+        return true;
+    }
+
+    // Both sequences are sorted by key: one merge pass
+    bool checkObject(const Node& n, const nlohmann::json& value, SchemaError* error) const {
+        const Property* p = properties.data() + n.firstProperty;
+        const Property* const end = p + n.propertyCount;
+        uint32_t requiredSeen = 0;
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            const std::string& key = it.key();
+            while (p != end && p->name < key) ++p;
+            if (p != end && p->name == key) {
+                requiredSeen += p->required;
+                if (!check(p->node, it.value(), error)) return prefix(error, key);
+                ++p;
+            } else if (n.additional != None) {
+                if (!check(n.additional, it.value(), error)) return prefix(error, key);
+            } else if (n.flags & NoAdditional) {
+                return fail(error, "unexpected property \"" + key + "\"");
+            }
+        }
+        if (requiredSeen < n.requiredCount) {
+            for (const Property* q = properties.data() + n.firstProperty; q != end; ++q) {
+                if (q->required && !value.contains(q->name)) {
+                    return fail(error, "missing required property \"" + q->name + "\"");
+                }
+            }
+        }
+        return true;
+    }
+
+    static std::string typeNames(uint8_t types) {
+        static const char* names[] = {"null", "boolean", "integer", "number", "string", "array", "object"};
+        if (types == 0) return "nothing";
+        std::string out;
+        for (int i = 0; i < 7; ++i) {
+            if (types & (1 << i)) {
+                if ((1 << i) == Integer && (types & Number)) continue;
+                if (!out.empty()) out += " or ";
+                out += names[i];
+            }
+        }
+        return out;
+    }
+};
+
+// ============================================================================
+// ToolValidators
+// ============================================================================
+//
+// Compiled inputSchema and outputSchema per tool name. Filled as tool list
+// pages arrive, trimmed to the listed tools once a listing completes and
+// cleared when the server announces notifications/tools/list_changed.
+// Names from the wire stay plain strings (interning them would keep every
+// name a server ever listed); lookups take the caller's string_view.
+
+class ToolValidators {
+public:
+    struct Schemas {
+        std::shared_ptr<const CompiledSchema> input;
+        std::shared_ptr<const CompiledSchema> output;  // null if the tool declares none
+        bool idempotent = false;                        // annotated readOnlyHint or idempotentHint
+    };
+
+private:
+    mutable std::shared_mutex mutex;
+    std::map<std::string, Schemas, std::less<>> byName;
+
+public:
+    void add(const std::vector<Tool>& tools) {
+        std::vector<std::pair<const std::string*, Schemas>> compiled;
+        compiled.reserve(tools.size());
+        for (const auto& tool : tools) {
+            Schemas schemas;
+            schemas.input = std::make_shared<const CompiledSchema>(CompiledSchema::compile(tool.inputSchema));
+            if (tool.outputSchema) {
+                schemas.output = std::make_shared<const CompiledSchema>(CompiledSchema::compile(*tool.outputSchema));
+            }
+            const auto& a = tool.annotations;
+            schemas.idempotent = a && ((a->readOnlyHint && *a->readOnlyHint) || (a->idempotentHint && *a->idempotentHint));
+            compiled.emplace_back(&tool.name, std::move(schemas));
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (auto& [name, schemas] : compiled) {
+            byName[*name] = std::move(schemas);
+        }
+    }
+
+    // After a complete listing: forgets tools that were not in it
+    void retain(const std::vector<std::string>& listed) {
+        std::unordered_set<std::string_view> keep(listed.begin(), listed.end());
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (auto it = byName.begin(); it != byName.end();) {
+            it = keep.count(it->first) ? std::next(it) : byName.erase(it);
+        }
+    }
+
+    void clear() {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        byName.clear();
+    }
+
+    // Empty for tools not seen in a listing
+    Schemas find(std::string_view name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = byName.find(name);
+        return it != byName.end() ? it->second : Schemas{};
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return byName.size();
+    }
+};
+
+} // namespace type
+} // namespace mcp
@@ -0,0 +1,251 @@
+#pragma once
+#include "schema_serialization.hpp"
+#include <fmt/format.h>
+#include <cmath>
+#include <string>
+#include <string_view>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Streaming JSON Writer
+// ============================================================================
+//
+// Serializes schema structs straight to bytes, without building an
+// intermediate nlohmann::json tree. Field names and optionality come from the
+// Reflect<> lists, so the output is equivalent to dump() of the DOM path.
+// Like dump(), strings that are not valid UTF-8 throw json::type_error (316);
+// binary values have no JSON text form and throw type_error 317.
+
+using WriteBuffer = fmt::memory_buffer;
+
+inline void writeRaw(WriteBuffer& out, std::string_view s) {
+    out.append(s.data(), s.data() + s.size());
+}
+
+// Length of the well-formed UTF-8 sequence at `s[at]` (lead byte >= 0x80),
+// per the Unicode table: no overlong forms, surrogates or code points past
+// U+10FFFF. Throws the same type_error as dump() otherwise.
+inline size_t utf8Sequence(std::string_view s, size_t at) {
+    const auto byte = [&](size_t i) { return static_cast<unsigned char>(s[i]); };
+    const auto lead = byte(at);
+    size_t length = 0;
+    unsigned char lo = 0x80, hi = 0xBF;  // bounds of the second byte
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) lo = 0xA0;
+        if (lead == 0xED) hi = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) lo = 0x90;
+        if (lead == 0xF4) hi = 0x8F;
+    }
+    size_t bad = at;
+    if (length != 0) {
+        for (bad = at + 1; bad < at + length && bad < s.size(); ++bad) {
+            const auto c = byte(bad);
+            if (c < (bad == at + 1 ? lo : 0x80) || c > (bad == at + 1 ? hi : 0xBF)) {
+                break;
+            }
+        }
+        if (bad == at + length) {
+            return length;
+        }
+    }
+    if (bad == s.size()) {
+        throw nlohmann::json::type_error::create(
+            316, fmt::format("incomplete UTF-8 string; last byte: 0x{:02X}", byte(s.size() - 1)), nullptr);
+    }
+    throw nlohmann::json::type_error::create(
+        316, fmt::format("invalid UTF-8 byte at index {}: 0x{:02X}", bad, byte(bad)), nullptr);
+}
+
+inline void writeString(WriteBuffer& out, std::string_view s) {
+    static constexpr char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    const char* run = s.data();
+    const char* end = s.data() + s.size();
+    for (const char* p = run; p != end; ++p) {
+        const auto c = static_cast<unsigned char>(*p);
+        if (c >= 0x80) {
+            p += utf8Sequence(s, static_cast<size_t>(p - s.data())) - 1;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(run, p);
+        run = p + 1;
+        switch (c) {
+            case '"':  writeRaw(out, "\\\""); break;
+            case '\\': writeRaw(out, "\\\\"); break;
+            case '\b': writeRaw(out, "\\b"); break;
+            case '\f': writeRaw(out, "\\f"); break;
+            case '\n': writeRaw(out, "\\n"); break;
+            case '\r': writeRaw(out, "\\r"); break;
+            case '\t': writeRaw(out, "\\t"); break;
+            default: {
+                const char esc[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.append(esc, esc + sizeof(esc));
+                break;
+            }
+        }
+    }
+    out.append(run, end);
+    out.push_back('"');
+}
+
+inline void writeNumber(WriteBuffer& out, double d) {
+    if (!std::isfinite(d)) {
+        writeRaw(out, "null");
+        return;
+    }
+    const auto start = out.size();
+    fmt::format_to(std::back_inserter(out), "{}", d);
+    // Keep floats distinguishable from integers, like nlohmann's dump()
+    std::string_view written(out.data() + start, out.size() - start);
+    if (written.find_first_of(".e") == std::string_view::npos) {
+        writeRaw(out, ".0");
+    }
+}
+
+inline void writeJson(WriteBuffer& out, const nlohmann::json& j) {
+    switch (j.type()) {
+        case nlohmann::json::value_t::object: {
+            out.push_back('{');
+            bool first = true;
+            for (auto it = j.begin(); it != j.end(); ++it) {
+                if (!first) out.push_back(',');
+                first = false;
+                writeString(out, it.key());
+                out.push_back(':');
+                writeJson(out, it.value());
+            }
+            out.push_back('}');
+            break;
+        }
+        case nlohmann::json::value_t::array: {
+            out.push_back('[');
+            bool first = true;
+            for (const auto& v : j) {
+                if (!first) out.push_back(',');
+                first = false;
+                writeJson(out, v);
+            }
+            out.push_back(']');
+            break;
+        }
+        case nlohmann::json::value_t::string:
+            writeString(out, j.get_ref<const std::string&>());
+            break;
+        case nlohmann::json::value_t::boolean:
+            writeRaw(out, j.get<bool>() ? "true" : "false");
+            break;
+        case nlohmann::json::value_t::number_integer:
+            writeRaw(out, fmt::format_int(j.get<int64_t>()).c_str());
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            writeRaw(out, fmt::format_int(j.get<uint64_t>()).c_str());
+            break;
+        case nlohmann::json::value_t::number_float:
+            writeNumber(out, j.get<double>());
+            break;
+        case nlohmann::json::value_t::binary:
+            throw nlohmann::json::type_error::create(317, "binary values cannot be written as JSON text", &j);
+        default:
+            // null and discarded values serialize as null
+            writeRaw(out, "null");
+            break;
+    }
+}
+
+template <class T>
+inline void writeValue(WriteBuffer& out, const T& v);
+
+template <class T>
+inline void writeObject(WriteBuffer& out, const T& value) {
+    out.push_back('{');
+    bool first = true;
+    forEachField(value, [&](const char* name, const auto& member) {
+        using M = std::decay_t<decltype(member)>;
+        if constexpr (is_optional<M>::value) {
+            if (!member) return;
+        }
+        if (!first) out.push_back(',');
+        first = false;
+        writeString(out, name);
+        out.push_back(':');
+        if constexpr (is_optional<M>::value) {
+            writeValue(out, *member);
+        } else {
+            writeValue(out, member);
+        }
+    });
+    out.push_back('}');
+}
+
+template <class T>
+struct is_vector : std::false_type {};
+
+template <class T, class A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <class T>
+struct is_string_map : std::false_type {};
+
+template <class V, class C, class A>
+struct is_string_map<std::map<std::string, V, C, A>> : std::true_type {};
+
+template <class T>
+inline void writeValue(WriteBuffer& out, const T& v) {
+    if constexpr (is_reflected<T>::value) {
+        writeObject(out, v);
+    } else if constexpr (is_variant<T>::value) {
+        std::visit([&](const auto& alt) { writeValue(out, alt); }, v);
+    } else if constexpr (std::is_same_v<T, nlohmann::json>) {
+        writeJson(out, v);
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        writeString(out, v);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        writeRaw(out, v ? "true" : "false");
+    } else if constexpr (std::is_integral_v<T>) {
+        writeRaw(out, fmt::format_int(v).c_str());
+    } else if constexpr (std::is_floating_point_v<T>) {
+        writeNumber(out, v);
+    } else if constexpr (is_vector<T>::value) {
+        out.push_back('[');
+        bool first = true;
+        for (const auto& e : v) {
+            if (!first) out.push_back(',');
+            first = false;
+            writeValue(out, e);
+        }
+        out.push_back(']');
+    } else if constexpr (is_string_map<T>::value) {
+        out.push_back('{');
+        bool first = true;
+        for (const auto& [key, e] : v) {
+            if (!first) out.push_back(',');
+            first = false;
+            writeString(out, key);
+            out.push_back(':');
+            writeValue(out, e);
+        }
+        out.push_back('}');
+    } else {
+        // Enums and anything else with an nlohmann to_json
+        writeJson(out, nlohmann::json(v));
+    }
+}
+
+template <class T>
+inline std::string toJsonString(const T& value) {
+    WriteBuffer out;
+    writeValue(out, value);
+    return fmt::to_string(out);
+}
+
+} // namespace type
+} // namespace mcp
@@ -0,0 +1,116 @@
+#pragma once
+#include "schema.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <boost/optional.hpp>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Structured Content Accessors
+// ============================================================================
+//
+// Typed, non-owning view over a tools/call structuredContent object (or any
+// nested object in it). Strings come back as string_views into the result,
+// and keys are looked up without building a std::string. Once the result
+// has been checked against the tool's outputSchema (CallOptions::
+// validateOutput), the typed getters cannot fail for declared, required
+// fields, so no second validation or re-parse pass is needed.
+//
+//     auto out = StructuredView::of(client.callTool("weather", args, opts));
+//     double t = out.number("temperature");
+//     std::string_view unit = out.string("unit");
+
+class StructuredView {
+    const nlohmann::json* value;
+
+    const nlohmann::json& at(std::string_view key) const {
+        const auto it = value->find(key);
+        if (it == value->end()) {
+            throw std::out_of_range("structuredContent has no field \"" + std::string(key) + "\"");
+        }
+        return *it;
+    }
+
+    const nlohmann::json* find(std::string_view key) const {
+        const auto it = value->find(key);
+        return it != value->end() && !it->is_null() ? &*it : nullptr;
+    }
+
+public:
+    explicit StructuredView(const nlohmann::json& object) : value(&object) {
+        if (!object.is_object()) {
+            throw std::invalid_argument("structuredContent is not an object");
+        }
+    }
+
+    // View over result["structuredContent"] of a CallToolResult
+    static StructuredView of(const nlohmann::json& callToolResult) {
+        const auto it = callToolResult.find("structuredContent");
+        if (it == callToolResult.end()) {
+            throw std::invalid_argument("Tool result has no structuredContent");
+        }
+        return StructuredView(*it);
+    }
+
+    static StructuredView of(const CallToolResult& result) {
+        if (!result.structuredContent) {
+            throw std::invalid_argument("Tool result has no structuredContent");
+        }
+        return StructuredView(*result.structuredContent);
+    }
+
+    bool has(std::string_view key) const { return find(key) != nullptr; }
+
+    std::string_view string(std::string_view key) const {
+        return at(key).get_ref<const std::string&>();
+    }
+
+    int64_t integer(std::string_view key) const { return at(key).get<int64_t>(); }
+    double number(std::string_view key) const { return at(key).get<double>(); }
+    bool boolean(std::string_view key) const { return at(key).get<bool>(); }
+
+    StructuredView object(std::string_view key) const { return StructuredView(at(key)); }
+
+    // Arrays are returned as-is; iterate and wrap elements as needed
+    const nlohmann::json& array(std::string_view key) const {
+        const auto& a = at(key);
+        if (!a.is_array()) {
+            throw std::invalid_argument("structuredContent field \"" + std::string(key) + "\" is not an array");
+        }
+        return a;
+    }
+
+    // Optional fields: none when absent or null
+    boost::optional<std::string_view> optionalString(std::string_view key) const {
+        const auto* v = find(key);
+        return v ? boost::optional<std::string_view>(v->get_ref<const std::string&>()) : boost::none;
+    }
+
+    boost::optional<int64_t> optionalInteger(std::string_view key) const {
+        const auto* v = find(key);
+        return v ? boost::optional<int64_t>(v->get<int64_t>()) : boost::none;
+    }
+
+    boost::optional<double> optionalNumber(std::string_view key) const {
+        const auto* v = find(key);
+        return v ? boost::optional<double>(v->get<double>()) : boost::none;
+    }
+
+    boost::optional<bool> optionalBoolean(std::string_view key) const {
+        const auto* v = find(key);
+        return v ? boost::optional<bool>(v->get<bool>()) : boost::none;
+    }
+
+    // Full conversion for types with a from_json, when a copy is wanted
+    template <class T>
+    T as() const { return value->get<T>(); }
+
+    const nlohmann::json& json() const { return *value; }
+};
+
+} // namespace type
+} // namespace mcp
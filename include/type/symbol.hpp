@@ -0,0 +1,156 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+namespace type {
+// ============================================================================
+// Symbol
+// ============================================================================
+//
+// Interned identifier: method names, server ids, and the tool names callers
+// name (callTool arguments, toolRateLimits keys). Names decoded from a
+// server's listings stay plain strings.
+// Equal strings share one immutable entry in the process-wide SymbolTable,
+// so a Symbol is a pointer: copies never allocate, equality is a pointer
+// compare and the hash is computed once at interning time. Interning a
+// string that is already known takes a shared lock and does not allocate.
+// Entries are never freed; intern identifiers, not payload.
+
+class Symbol {
+public:
+    struct Entry {
+        std::string text;
+        size_t hash;
+    };
+
+    Symbol() noexcept : entry(&emptyEntry()) {}
+    Symbol(std::string_view s);
+    Symbol(const std::string& s) : Symbol(std::string_view(s)) {}
+    Symbol(const char* s) : Symbol(std::string_view(s)) {}
+
+    const std::string& str() const noexcept { return entry->text; }
+    std::string_view view() const noexcept { return entry->text; }
+    const char* c_str() const noexcept { return entry->text.c_str(); }
+    size_t size() const noexcept { return entry->text.size(); }
+    bool empty() const noexcept { return entry->text.empty(); }
+    size_t hash() const noexcept { return entry->hash; }
+
+    operator std::string_view() const noexcept { return entry->text; }
+    operator const std::string&() const noexcept { return entry->text; }
+
+    friend bool operator==(Symbol a, Symbol b) noexcept { return a.entry == b.entry; }
+    friend bool operator!=(Symbol a, Symbol b) noexcept { return a.entry != b.entry; }
+    friend bool operator==(Symbol a, std::string_view b) noexcept { return a.view() == b; }
+    friend bool operator!=(Symbol a, std::string_view b) noexcept { return a.view() != b; }
+    friend bool operator==(std::string_view a, Symbol b) noexcept { return a == b.view(); }
+    friend bool operator!=(std::string_view a, Symbol b) noexcept { return a != b.view(); }
+    friend bool operator==(Symbol a, const std::string& b) noexcept { return a.view() == b; }
+    friend bool operator!=(Symbol a, const std::string& b) noexcept { return a.view() != b; }
+    friend bool operator==(Symbol a, const char* b) noexcept { return a.view() == b; }
+    friend bool operator!=(Symbol a, const char* b) noexcept { return a.view() != b; }
+    // Lexicographic, so sorted containers keep their usual order
+    friend bool operator<(Symbol a, Symbol b) noexcept { return a.entry != b.entry && a.view() < b.view(); }
+
+    friend std::ostream& operator<<(std::ostream& os, Symbol s) { return os << s.view(); }
+
+private:
+    const Entry* entry;
+
+    static const Entry& emptyEntry() noexcept {
+        static const Entry empty{std::string(), std::hash<std::string_view>{}(std::string_view())};
+        return empty;
+    }
+
+    friend class SymbolTable;
+};
+
+class SymbolTable {
+    static constexpr size_t Shards = 32;
+
+    struct Key {
+        std::string_view text;
+        size_t hash;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const noexcept { return k.hash; }
+    };
+    struct KeyEqual {
+        bool operator()(const Key& a, const Key& b) const noexcept { return a.text == b.text; }
+    };
+
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<Key, const Symbol::Entry*, KeyHash, KeyEqual> index;
+        std::deque<Symbol::Entry> entries;  // stable addresses
+    };
+
+    std::array<Shard, Shards> shards;
+
+public:
+    // Intentionally leaked so Symbols stay valid during static destruction
+    static SymbolTable& instance() {
+        static SymbolTable* table = new SymbolTable;
+        return *table;
+    }
+
+    const Symbol::Entry* intern(std::string_view s) {
+        if (s.empty()) {
+            return &Symbol::emptyEntry();
+        }
+        const size_t hash = std::hash<std::string_view>{}(s);
+        Shard& shard = shards[(hash >> 8) % Shards];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.index.find(Key{s, hash});
+            if (it != shard.index.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.index.find(Key{s, hash});
+        if (it != shard.index.end()) {
+            return it->second;
+        }
+        const auto& entry = shard.entries.emplace_back(Symbol::Entry{std::string(s), hash});
+        shard.index.emplace(Key{entry.text, hash}, &entry);
+        return &entry;
+    }
+
+    size_t size() {
+        size_t n = 0;
+        for (auto& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            n += shard.entries.size();
+        }
+        return n;
+    }
+};
+
+inline Symbol::Symbol(std::string_view s) : entry(SymbolTable::instance().intern(s)) {}
+
+inline void to_json(nlohmann::json& j, const Symbol& s) {
+    j = s.str();
+}
+
+// Looks the string up in place; allocates only the first time it is seen
+inline void from_json(const nlohmann::json& j, Symbol& s) {
+    s = Symbol(j.get_ref<const std::string&>());
+}
+
+} // namespace type
+} // namespace mcp
+
+template <>
+struct std::hash<mcp::type::Symbol> {
+    size_t operator()(mcp::type::Symbol s) const noexcept { return s.hash(); }
+};